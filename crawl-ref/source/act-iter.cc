@@ -4,6 +4,7 @@
 
 #include "env.h"
 #include "losglobal.h"
+#include "mon-util.h"
 
 actor_near_iterator::actor_near_iterator(coord_def c, los_type los)
     : center(c), _los(los), viewer(nullptr), i(-1)
@@ -64,7 +65,7 @@ bool actor_near_iterator::valid(const actor* a) const
 void actor_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = next_monster_slot(i)) >= MAX_MONSTERS)
              return;
     while (!valid(**this));
 }
@@ -72,18 +73,16 @@ void actor_near_iterator::advance()
 //////////////////////////////////////////////////////////////////////////
 
 monster_near_iterator::monster_near_iterator(coord_def c, los_type los)
-    : center(c), _los(los), viewer(nullptr), i(0)
+    : center(c), _los(los), viewer(nullptr), i(-1)
 {
-    if (!valid(&env.mons[0]))
-        advance();
+    advance();
     begin_point = i;
 }
 
 monster_near_iterator::monster_near_iterator(const actor *a, los_type los)
-    : center(a->pos()), _los(los), viewer(a), i(0)
+    : center(a->pos()), _los(los), viewer(a), i(-1)
 {
-    if (!valid(&env.mons[0]))
-        advance();
+    advance();
     begin_point = i;
 }
 
@@ -154,7 +153,7 @@ bool monster_near_iterator::valid(const monster* a) const
 void monster_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = next_monster_slot(i)) >= MAX_MONSTERS)
              return;
     while (!valid(**this));
 }
@@ -162,10 +161,9 @@ void monster_near_iterator::advance()
 //////////////////////////////////////////////////////////////////////////
 
 monster_iterator::monster_iterator()
-    : i(0)
+    : i(-1)
 {
-    while (i < MAX_MONSTERS && !env.mons[i].alive())
-        i++;
+    advance();
 }
 
 monster_iterator::operator bool() const
@@ -188,9 +186,7 @@ monster* monster_iterator::operator->() const
 
 monster_iterator& monster_iterator::operator++()
 {
-    while (++i < MAX_MONSTERS)
-        if (env.mons[i].alive())
-            break;
+    advance();
     return *this;
 }
 
@@ -204,7 +200,7 @@ monster_iterator monster_iterator::operator++(int)
 void monster_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = next_monster_slot(i)) >= MAX_MONSTERS)
              return;
     while (!(*this)->alive());
 }
@@ -38,6 +38,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/butcher.cc \
     $(CRAWL_PATH)/bloodspatter.cc \
     $(CRAWL_PATH)/chardump.cc \
+    $(CRAWL_PATH)/chunk-delta.cc \
     $(CRAWL_PATH)/cio.cc \
     $(CRAWL_PATH)/cloud.cc \
     $(CRAWL_PATH)/clua.cc \
@@ -104,6 +105,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/hints.cc \
     $(CRAWL_PATH)/hiscores.cc \
     $(CRAWL_PATH)/initfile.cc \
+    $(CRAWL_PATH)/intern.cc \
     $(CRAWL_PATH)/invent.cc \
     $(CRAWL_PATH)/item-use.cc \
     $(CRAWL_PATH)/item-name.cc \
@@ -1065,21 +1065,49 @@ void bolt::affect_cell()
         affect_ground();
 }
 
-static void _undo_tracer(bolt &orig, bolt &copy)
+// The parts of a bolt that firing a tracer may change, which are put back
+// afterwards. Monsters fire a great many tracers, so this is kept to what
+// is needed rather than copying the whole bolt (names, path and all).
+struct tracer_undo
 {
     // FIXME: we should have a better idea of what gets changed!
-    orig.target           = copy.target;
-    orig.source           = copy.source;
-    orig.aimed_at_spot    = copy.aimed_at_spot;
-    orig.extra_range_used = copy.extra_range_used;
-    orig.auto_hit         = copy.auto_hit;
-    orig.ray              = copy.ray;
-    orig.colour           = copy.colour;
-    orig.flavour          = copy.flavour;
-    orig.real_flavour     = copy.real_flavour;
-    orig.bounces          = copy.bounces;
-    orig.bounce_pos       = copy.bounce_pos;
-}
+    coord_def  target;
+    coord_def  source;
+    bool       aimed_at_spot;
+    int        extra_range_used;
+    bool       auto_hit;
+    ray_def    ray;
+    colour_t   colour;
+    beam_type  flavour;
+    beam_type  real_flavour;
+    int        bounces;
+    coord_def  bounce_pos;
+
+    explicit tracer_undo(const bolt &beam)
+        : target(beam.target), source(beam.source),
+          aimed_at_spot(beam.aimed_at_spot),
+          extra_range_used(beam.extra_range_used), auto_hit(beam.auto_hit),
+          ray(beam.ray), colour(beam.colour), flavour(beam.flavour),
+          real_flavour(beam.real_flavour), bounces(beam.bounces),
+          bounce_pos(beam.bounce_pos)
+    {
+    }
+
+    void apply(bolt &beam) const
+    {
+        beam.target           = target;
+        beam.source           = source;
+        beam.aimed_at_spot    = aimed_at_spot;
+        beam.extra_range_used = extra_range_used;
+        beam.auto_hit         = auto_hit;
+        beam.ray              = ray;
+        beam.colour           = colour;
+        beam.flavour          = flavour;
+        beam.real_flavour     = real_flavour;
+        beam.bounces          = bounces;
+        beam.bounce_pos       = bounce_pos;
+    }
+};
 
 // This saves some important things before calling fire().
 void bolt::fire()
@@ -1091,19 +1119,16 @@ void bolt::fire()
 
     if (is_tracer)
     {
-        bolt boltcopy = *this;
-        if (special_explosion != nullptr)
-            boltcopy.special_explosion = new bolt(*special_explosion);
+        const tracer_undo undo(*this);
+        const tracer_undo explosion_undo(special_explosion ? *special_explosion
+                                                           : *this);
 
         do_fire();
 
         if (special_explosion != nullptr)
-        {
-            _undo_tracer(*special_explosion, *boltcopy.special_explosion);
-            delete boltcopy.special_explosion;
-        }
+            explosion_undo.apply(*special_explosion);
 
-        _undo_tracer(*this, boltcopy);
+        undo.apply(*this);
     }
     else
         do_fire();
@@ -1134,7 +1159,11 @@ void bolt::do_fire()
     }
 
     apply_beam_conducts();
-    cursor_control coff(false);
+
+    // Monster tracers are only weighing up a shot, and show nothing.
+    unique_ptr<cursor_control> coff;
+    if (!is_tracer || YOU_KILL(thrower))
+        coff.reset(new cursor_control(false));
 
 #ifdef USE_TILE
     tile_beam = -1;
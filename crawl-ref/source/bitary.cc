@@ -34,14 +34,6 @@ void bit_vector::reset()
         data[w] = 0;
 }
 
-bool bit_vector::get(unsigned long index) const
-{
-    ASSERT(index < size);
-    int w = index / LONGSIZE;
-    int b = index % LONGSIZE;
-    return data[w] & (1UL << b);
-}
-
 void bit_vector::set(unsigned long index, bool value)
 {
     ASSERT(index < size);
@@ -77,3 +69,12 @@ bit_vector bit_vector::operator & (const bit_vector& other) const
         res.data[w] = data[w] & other.data[w];
     return res;
 }
+
+bit_vector& bit_vector::or_and(const bit_vector& a, const bit_vector& b)
+{
+    ASSERT(size == a.size);
+    ASSERT(size == b.size);
+    for (int w = 0; w < nwords; ++w)
+        data[w] |= a.data[w] & b.data[w];
+    return *this;
+}
@@ -26,12 +26,14 @@ public:
 
     void reset();
 
-    bool get(unsigned long index) const;
+    inline bool get(unsigned long index) const;
     void set(unsigned long index, bool value = true);
 
     bit_vector& operator |= (const bit_vector& other);
     bit_vector& operator &= (const bit_vector& other);
     bit_vector  operator & (const bit_vector& other) const;
+    // *this |= (a & b), without allocating a temporary.
+    bit_vector& or_and(const bit_vector& a, const bit_vector& b);
 
 protected:
     unsigned long size;
@@ -40,6 +42,13 @@ protected:
 };
 
 #define LONGSIZE (sizeof(unsigned long)*8)
+
+// Inline, since los.cc calls this for every cellray on every LOS update.
+inline bool bit_vector::get(unsigned long index) const
+{
+    ASSERT(index < size);
+    return data[index / LONGSIZE] & (1UL << (index % LONGSIZE));
+}
 #ifndef ULONG_MAX
 #define ULONG_MAX ((unsigned long)(-1))
 #endif
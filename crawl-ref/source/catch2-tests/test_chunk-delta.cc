@@ -0,0 +1,91 @@
+#include <random>
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "chunk-delta.h"
+#include "errors.h"
+
+namespace
+{
+    // Something like a level: long runs, with a little noise.
+    vector<unsigned char> _random_chunk(std::mt19937 &gen, size_t len)
+    {
+        std::uniform_int_distribution<int> roll(0, 99);
+        vector<unsigned char> data(len);
+        unsigned char c = 0;
+        for (unsigned char &b : data)
+        {
+            if (roll(gen) < 10)
+                c = roll(gen);
+            b = roll(gen) < 3 ? roll(gen) : c;
+        }
+        return data;
+    }
+
+    // Overwrite, insert and remove a few short stretches.
+    vector<unsigned char> _mutate(std::mt19937 &gen, vector<unsigned char> data,
+                                  int edits)
+    {
+        std::uniform_int_distribution<int> roll(0, 255);
+        for (int i = 0; i < edits; ++i)
+        {
+            std::uniform_int_distribution<size_t> pos(0, data.size());
+            const size_t at = pos(gen);
+            const size_t len = roll(gen) % 40;
+            switch (roll(gen) % 3)
+            {
+            case 0:
+                for (size_t j = at; j < at + len && j < data.size(); ++j)
+                    data[j] = roll(gen);
+                break;
+            case 1:
+                for (size_t j = 0; j < len; ++j)
+                    data.insert(data.begin() + at, roll(gen));
+                break;
+            default:
+                data.erase(data.begin() + at,
+                           data.begin() + min(at + len, data.size()));
+                break;
+            }
+        }
+        return data;
+    }
+}
+
+TEST_CASE("chunk deltas rebuild the chunk they describe", "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 11));
+    const auto edits = GENERATE(0, 1, 10, 100);
+
+    CAPTURE(seed, edits);
+
+    std::mt19937 gen(seed);
+    const vector<unsigned char> base = _random_chunk(gen, 200000);
+    const vector<unsigned char> now = _mutate(gen, base, edits);
+
+    vector<unsigned char> delta, out;
+    REQUIRE(make_chunk_delta(base, now, delta, now.size()));
+    apply_chunk_delta(base, delta, out);
+    REQUIRE(out == now);
+
+    // Each edit costs some literal bytes and a copy, but nothing like the
+    // whole chunk.
+    REQUIRE(delta.size() <= 32 + edits * 120);
+}
+
+TEST_CASE("chunk deltas give up on unrelated data", "[single-file]")
+{
+    std::mt19937 gen(1);
+    const vector<unsigned char> base = _random_chunk(gen, 50000);
+    const vector<unsigned char> other = _random_chunk(gen, 50000);
+
+    vector<unsigned char> delta;
+    REQUIRE_FALSE(make_chunk_delta(base, other, delta, other.size() / 10));
+
+    // Nor are deltas applied to the wrong base.
+    REQUIRE(make_chunk_delta(base, base, delta, 100));
+    vector<unsigned char> out;
+    REQUIRE_THROWS_AS(apply_chunk_delta(other, delta, out), corrupted_save);
+}
@@ -0,0 +1,25 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "intern.h"
+
+TEST_CASE("interned strings keep their handles", "[single-file]")
+{
+    REQUIRE(lookup_interned("test_intern never interned") == NO_INTERN);
+
+    const intern_id a = intern_string("test_intern a");
+    const intern_id b = intern_string("test_intern b");
+    REQUIRE(a != b);
+    REQUIRE(intern_string("test_intern a") == a);
+    REQUIRE(lookup_interned("test_intern b") == b);
+
+    // Plenty of later strings move neither the handles nor the strings.
+    const string &a_str = interned_string(a);
+    for (int i = 0; i < 10000; ++i)
+        intern_string("test_intern " + to_string(i));
+    REQUIRE(&interned_string(a) == &a_str);
+    REQUIRE(a_str == "test_intern a");
+    REQUIRE(interned_string(b) == "test_intern b");
+    REQUIRE(lookup_interned("test_intern a") == a);
+}
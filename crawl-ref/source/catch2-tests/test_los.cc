@@ -0,0 +1,68 @@
+#include <random>
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "coord.h"
+#include "coord-circle.h"
+#include "coordit.h"
+#include "los.h"
+#include "losparam.h"
+
+namespace
+{
+    // Random opacities for every cell on the map.
+    class opacity_random_grid : public opacity_func
+    {
+    public:
+        opacity_random_grid(unsigned int seed, int half_pct, int opaque_pct)
+        {
+            std::mt19937 gen(seed);
+            std::uniform_int_distribution<int> roll(0, 99);
+            for (rectangle_iterator ri(0); ri; ++ri)
+            {
+                const int r = roll(gen);
+                grid(*ri) = r < opaque_pct ? OPC_OPAQUE
+                          : r < opaque_pct + half_pct ? OPC_HALF
+                          : OPC_CLEAR;
+            }
+        }
+
+        CLONE(opacity_random_grid)
+
+        opacity_type operator()(const coord_def& p) const override
+        {
+            return grid(p);
+        }
+
+    private:
+        FixedArray<opacity_type, GXM, GYM> grid;
+    };
+}
+
+TEST_CASE("losight agrees with find_ray on random opacity grids",
+          "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 21));
+    const auto half_pct = GENERATE(0, 10, 30);
+    const auto opaque_pct = GENERATE(0, 15, 40);
+
+    CAPTURE(seed, half_pct, opaque_pct);
+
+    const opacity_random_grid opc(seed, half_pct, opaque_pct);
+    const circle_def bounds(LOS_MAX_RANGE, C_SQUARE);
+    const coord_def center(GXM / 2, GYM / 2);
+
+    los_grid sh;
+    losight(sh, center, opc, bounds);
+
+    for (rectangle_iterator ri(center, LOS_MAX_RANGE); ri; ++ri)
+    {
+        const coord_def rel = *ri - center;
+        CAPTURE(rel.x, rel.y);
+        const bool expected = rel.origin()
+                              || exists_ray(center, *ri, opc, LOS_MAX_RANGE);
+        REQUIRE(sh(rel) == expected);
+    }
+}
@@ -0,0 +1,24 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "map-cell.h"
+
+TEST_CASE( "Copies of a map cell share its monster.", "[single-file]" ) {
+    map_cell cell;
+    cell.set_monster(monster_info(MONS_KOBOLD, MONS_KOBOLD));
+
+    map_cell copy = cell;
+    REQUIRE(copy.monsterinfo() == cell.monsterinfo());
+
+    // Changing one copy leaves the other alone.
+    copy.mutable_monsterinfo()->pos = coord_def(3, 4);
+    REQUIRE(copy.monsterinfo() != cell.monsterinfo());
+    REQUIRE(cell.monsterinfo()->pos == coord_def(0, 0));
+    REQUIRE(copy.monsterinfo()->type == MONS_KOBOLD);
+
+    copy = cell;
+    cell.clear_monster();
+    REQUIRE(copy.monsterinfo()->type == MONS_KOBOLD);
+    REQUIRE(copy.monsterinfo()->pos == coord_def(0, 0));
+}
@@ -0,0 +1,291 @@
+#include <deque>
+#include <random>
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "coord.h"
+#include "coordit.h"
+#include "env.h"
+#include "feature.h"
+#include "mon-pathfind.h"
+#include "mon-place.h"
+#include "mon-util.h"
+#include "monster.h"
+#include "player.h"
+#include "terrain.h"
+#include "traps.h"
+
+namespace
+{
+    // Shortest number of king moves from src to every grid, or -1.
+    FixedArray<int, GXM, GYM> _bfs_distances(const coord_def& src)
+    {
+        FixedArray<int, GXM, GYM> dist(-1);
+        std::deque<coord_def> todo;
+        dist(src) = 0;
+        todo.push_back(src);
+        while (!todo.empty())
+        {
+            const coord_def p = todo.front();
+            todo.pop_front();
+            for (adjacent_iterator ai(p); ai; ++ai)
+            {
+                if (in_bounds(*ai) && env.grid(*ai) == DNGN_FLOOR
+                    && dist(*ai) == -1)
+                {
+                    dist(*ai) = dist(p) + 1;
+                    todo.push_back(*ai);
+                }
+            }
+        }
+        return dist;
+    }
+
+    monster* _place_monster(monster_type mt, const coord_def& p)
+    {
+        monster* mon = get_free_monster();
+        REQUIRE(mon);
+        mon->type = mt;
+        mon->base_monster = MONS_NO_MONSTER;
+        define_monster(*mon);
+        mon->attitude = ATT_HOSTILE;
+        mon->position = p;
+        env.mgrid(p) = mon->mindex();
+        return mon;
+    }
+
+    void _remove_monster(monster* mon)
+    {
+        env.mgrid(mon->pos()) = NON_MONSTER;
+        mon->reset();
+    }
+
+    // How far a monster at from walks following waypoints, if it goes
+    // straight from each one to the next.
+    int _waypoint_length(coord_def from, const vector<coord_def>& waypoints)
+    {
+        int length = 0;
+        for (const coord_def& w : waypoints)
+        {
+            length += grid_distance(from, w);
+            from = w;
+        }
+        return length;
+    }
+
+    // Checks that a hostile jackal at p reads a shortest path to the player
+    // off this turn's flow field, or is told there is none.
+    void _check_shared_path(const coord_def& p,
+                            const FixedArray<int, GXM, GYM>& dist)
+    {
+        CAPTURE(p.x, p.y, dist(p));
+
+        monster* mon = _place_monster(MONS_JACKAL, p);
+        vector<coord_def> waypoints;
+        const bool found = shared_path_to_player(mon, GXM, waypoints);
+        _remove_monster(mon);
+
+        REQUIRE(found == (dist(p) >= 0));
+        if (!found)
+            return;
+
+        REQUIRE(!waypoints.empty());
+        REQUIRE(waypoints.back() == you.pos());
+        REQUIRE(_waypoint_length(p, waypoints) == dist(p));
+    }
+}
+
+TEST_CASE("monster_pathfind finds shortest paths on random maps",
+          "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 11));
+    const auto wall_pct = GENERATE(0, 20, 35);
+
+    CAPTURE(seed, wall_pct);
+
+    // Terrain predicates look features up in this table.
+    init_show_table();
+
+    const auto old_grid = env.grid;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> roll(0, 99);
+    std::uniform_int_distribution<int> roll_x(X_BOUND_1 + 1, X_BOUND_2 - 1);
+    std::uniform_int_distribution<int> roll_y(Y_BOUND_1 + 1, Y_BOUND_2 - 1);
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        env.grid(*ri) = !in_bounds(*ri) ? DNGN_PERMAROCK_WALL
+                        : roll(gen) < wall_pct ? DNGN_ROCK_WALL
+                        : DNGN_FLOOR;
+    }
+
+    // The same instance is reused, so that stale state from an earlier
+    // search would show up in the later ones.
+    monster_pathfind mp;
+    for (int i = 0; i < 8; ++i)
+    {
+        const coord_def src(roll_x(gen), roll_y(gen));
+        const coord_def dst(roll_x(gen), roll_y(gen));
+        env.grid(src) = DNGN_FLOOR;
+        env.grid(dst) = DNGN_FLOOR;
+
+        CAPTURE(i, src.x, src.y, dst.x, dst.y);
+
+        const auto dist = _bfs_distances(src);
+        const bool found = mp.init_pathfind(src, dst);
+        REQUIRE(found == (dist(dst) >= 0));
+        if (!found)
+            continue;
+
+        const vector<coord_def> path = mp.backtrack();
+        REQUIRE(path.front() == src);
+        REQUIRE(path.back() == dst);
+        REQUIRE(static_cast<int>(path.size()) - 1 == dist(dst));
+        for (size_t j = 1; j < path.size(); ++j)
+        {
+            REQUIRE(grid_distance(path[j - 1], path[j]) == 1);
+            REQUIRE(env.grid(path[j]) == DNGN_FLOOR);
+        }
+    }
+
+    env.grid = old_grid;
+}
+
+TEST_CASE("monsters share shortest paths to the player", "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 6));
+    const auto wall_pct = GENERATE(0, 20, 35);
+
+    CAPTURE(seed, wall_pct);
+
+    init_show_table();
+    init_monsters();
+
+    const auto old_grid = env.grid;
+    const coord_def old_pos = you.pos();
+    const int old_turns = you.num_turns;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> roll(0, 99);
+    std::uniform_int_distribution<int> roll_x(X_BOUND_1 + 1, X_BOUND_2 - 1);
+    std::uniform_int_distribution<int> roll_y(Y_BOUND_1 + 1, Y_BOUND_2 - 1);
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        env.grid(*ri) = !in_bounds(*ri) ? DNGN_PERMAROCK_WALL
+                        : roll(gen) < wall_pct ? DNGN_ROCK_WALL
+                        : DNGN_FLOOR;
+    }
+
+    // Nothing left over from an earlier test can be current.
+    you.num_turns = 1000 * seed + wall_pct;
+    you.position = coord_def(roll_x(gen), roll_y(gen));
+    env.grid(you.pos()) = DNGN_FLOOR;
+
+    vector<coord_def> spots;
+    for (int i = 0; i < 12; ++i)
+    {
+        coord_def p(roll_x(gen), roll_y(gen));
+        if (p == you.pos())
+            continue;
+        env.grid(p) = DNGN_FLOOR;
+        spots.push_back(p);
+    }
+    // Near before far, so that later queries have to settle the field
+    // further out, then a near one again, which is already settled.
+    const coord_def player = you.pos();
+    sort(spots.begin(), spots.end(),
+         [player](const coord_def& a, const coord_def& b)
+         {
+             return grid_distance(a, player) < grid_distance(b, player);
+         });
+    spots.push_back(spots.front());
+
+    SECTION("paths from an unchanged map")
+    {
+        const auto dist = _bfs_distances(you.pos());
+        for (const coord_def& p : spots)
+            _check_shared_path(p, dist);
+    }
+
+    SECTION("paths after the terrain changes")
+    {
+        _check_shared_path(spots.back(), _bfs_distances(you.pos()));
+
+        // Knock down or raise walls around the player, where the field has
+        // certainly been settled.
+        for (rectangle_iterator ri(you.pos(), 6); ri; ++ri)
+        {
+            if (!in_bounds(*ri) || *ri == you.pos()
+                || find(spots.begin(), spots.end(), *ri) != spots.end()
+                || roll(gen) >= 30)
+            {
+                continue;
+            }
+            env.grid(*ri) = env.grid(*ri) == DNGN_FLOOR ? DNGN_ROCK_WALL
+                                                        : DNGN_FLOOR;
+            set_terrain_changed(*ri);
+        }
+
+        const auto dist = _bfs_distances(you.pos());
+        for (const coord_def& p : spots)
+            _check_shared_path(p, dist);
+    }
+
+    env.grid = old_grid;
+    you.position = old_pos;
+    you.num_turns = old_turns;
+}
+
+TEST_CASE("monsters that can't take the shared path search on their own",
+          "[single-file]")
+{
+    init_show_table();
+    init_monsters();
+
+    const auto old_grid = env.grid;
+    const coord_def old_pos = you.pos();
+    const int old_turns = you.num_turns;
+
+    // A corridor from the player to two jackals, with an arrow trap in the
+    // middle. A healthy jackal doesn't mind the trap; a badly hurt one does,
+    // but otherwise moves just the same way.
+    for (rectangle_iterator ri(0); ri; ++ri)
+        env.grid(*ri) = in_bounds(*ri) ? DNGN_ROCK_WALL : DNGN_PERMAROCK_WALL;
+    for (int x = 10; x <= 40; ++x)
+        env.grid(coord_def(x, 20)) = DNGN_FLOOR;
+
+    const coord_def trap_pos(20, 20);
+    trap_def trap;
+    trap.pos = trap_pos;
+    trap.type = TRAP_ARROW;
+    trap.ammo_qty = 1;
+    env.trap[trap_pos] = trap;
+    env.grid(trap_pos) = trap_feature(TRAP_ARROW);
+
+    you.num_turns = 999999;
+    you.position = coord_def(10, 20);
+
+    monster* healthy = _place_monster(MONS_JACKAL, coord_def(30, 20));
+    monster* hurt = _place_monster(MONS_JACKAL, coord_def(35, 20));
+    hurt->hit_points = 1;
+    hurt->max_hit_points = max(hurt->max_hit_points, 10);
+
+    vector<coord_def> waypoints;
+    REQUIRE(shared_path_to_player(healthy, GXM, waypoints));
+    REQUIRE(waypoints.back() == you.pos());
+
+    // Both are in the same movement class, so the hurt jackal would be
+    // handed the same field, but the path through the trap is rejected.
+    waypoints.clear();
+    REQUIRE_FALSE(shared_path_to_player(hurt, GXM, waypoints));
+    REQUIRE(waypoints.empty());
+
+    _remove_monster(healthy);
+    _remove_monster(hurt);
+    env.trap.erase(trap_pos);
+    env.grid = old_grid;
+    you.position = old_pos;
+    you.num_turns = old_turns;
+}
@@ -0,0 +1,178 @@
+#include <random>
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "package.h"
+#include "syscalls.h"
+
+namespace
+{
+    vector<char> _random_bytes(std::mt19937 &gen, size_t len, int spread)
+    {
+        std::uniform_int_distribution<int> roll(0, spread);
+        vector<char> data(len);
+        for (char &c : data)
+            c = roll(gen);
+        return data;
+    }
+
+    void _write_chunk(package &pkg, const string &name,
+                      const vector<char> &data)
+    {
+        chunk_writer *w = pkg.writer(name);
+        w->write(data.data(), data.size());
+        delete w;
+    }
+
+    vector<char> _read_chunk(package &pkg, const string &name)
+    {
+        vector<char> data;
+        chunk_reader *r = pkg.reader(name);
+        REQUIRE(r);
+        r->read_all(data);
+        delete r;
+        return data;
+    }
+}
+
+TEST_CASE("package chunks survive commits and reopening", "[single-file]")
+{
+    const string file = "catch2-test-package.tmp";
+    std::mt19937 gen(1);
+
+    // Barely compressible data spans many blocks.
+    map<string, vector<char>> chunks;
+    chunks["small"] = _random_bytes(gen, 100, 3);
+    chunks["big"] = _random_bytes(gen, 300000, 255);
+    chunks["level"] = _random_bytes(gen, 50000, 7);
+
+    {
+        package pkg(file.c_str(), true, true);
+        for (const auto &ch : chunks)
+            _write_chunk(pkg, ch.first, ch.second);
+    }
+
+    {
+        package pkg(file.c_str(), true);
+        for (const auto &ch : chunks)
+            REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+
+        // Rewrite chunks while a reader is still going, on either side of
+        // a commit.
+        chunk_reader *big = pkg.reader("big");
+        vector<char> head(1000);
+        REQUIRE(big->read(head.data(), head.size()) == head.size());
+
+        chunks["small"] = _random_bytes(gen, 70000, 255);
+        _write_chunk(pkg, "small", chunks["small"]);
+        pkg.commit();
+        REQUIRE(_read_chunk(pkg, "small") == chunks["small"]);
+
+        vector<char> rest;
+        big->read_all(rest);
+        delete big;
+        head.insert(head.end(), rest.begin(), rest.end());
+        REQUIRE(head == chunks["big"]);
+
+        chunks["level"] = _random_bytes(gen, 20000, 15);
+        _write_chunk(pkg, "level", chunks["level"]);
+        pkg.commit();
+        for (const auto &ch : chunks)
+            REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+    }
+
+    {
+        package pkg(file.c_str(), false);
+        REQUIRE(pkg.list_chunks().size() == chunks.size());
+        for (const auto &ch : chunks)
+            REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+    }
+
+    unlink_u(file.c_str());
+}
+
+TEST_CASE("package codecs are recorded in the header", "[single-file]")
+{
+    const string file = "catch2-test-package.tmp";
+    std::mt19937 gen(2);
+
+    const vector<char> data = _random_bytes(gen, 100000, 7);
+    const auto codec = GENERATE(PCODEC_ZLIB, PCODEC_NONE);
+    const auto level = GENERATE(1, 9);
+
+    CAPTURE(codec, level);
+
+    plen_t size;
+    {
+        package pkg(file.c_str(), true, true);
+        pkg.set_codec(codec);
+        pkg.set_compression_level(level);
+        _write_chunk(pkg, "level", data);
+        pkg.commit();
+        size = pkg.get_size();
+    }
+
+    // Three random bits per byte squeeze down to a bit over 3/8.
+    if (codec == PCODEC_NONE)
+        REQUIRE(size > data.size());
+    else
+        REQUIRE(size < data.size() / 2);
+
+    {
+        package pkg(file.c_str(), false);
+        REQUIRE(pkg.get_codec() == codec);
+        REQUIRE(_read_chunk(pkg, "level") == data);
+    }
+
+    unlink_u(file.c_str());
+}
+
+TEST_CASE("package writes in the background", "[single-file]")
+{
+    const string file = "catch2-test-package.tmp";
+    std::mt19937 gen(3);
+
+    map<string, vector<char>> chunks;
+    {
+        package pkg(file.c_str(), true, true);
+        pkg.write_in_background();
+
+        // Several rounds of saves, each read back before the writer thread
+        // has necessarily got to it.
+        for (int round = 0; round < 20; ++round)
+        {
+            const string name = "lev" + to_string(round % 7);
+            chunks[name] = _random_bytes(gen, 20000 + 1000 * round, 15);
+            _write_chunk(pkg, name, chunks[name]);
+            chunks["you"] = _random_bytes(gen, 5000, 255);
+            _write_chunk(pkg, "you", chunks["you"]);
+            if (round % 5 == 4)
+            {
+                pkg.delete_chunk(name);
+                chunks.erase(name);
+                REQUIRE_FALSE(pkg.has_chunk(name));
+                REQUIRE_FALSE(pkg.reader(name));
+            }
+            pkg.commit();
+
+            REQUIRE(pkg.list_chunks().size() == chunks.size());
+            for (const auto &ch : chunks)
+                REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+        }
+
+        pkg.flush();
+        for (const auto &ch : chunks)
+            REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+    }
+
+    {
+        package pkg(file.c_str(), false);
+        REQUIRE(pkg.list_chunks().size() == chunks.size());
+        for (const auto &ch : chunks)
+            REQUIRE(_read_chunk(pkg, ch.first) == chunks[ch.first]);
+    }
+
+    unlink_u(file.c_str());
+}
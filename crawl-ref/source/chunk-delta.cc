@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Describing a save chunk as its differences to an older version.
+**/
+
+#include "AppHdr.h"
+
+#include "chunk-delta.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "errors.h"
+
+/*
+Format:
+  byte    DELTA_FORMAT
+  varint  size of the base
+  varint  checksum of the base
+  varint  size of the result
+  ops, until the end of the delta:
+    varint  len << 1 | DELTA_LITERAL, followed by len literal bytes, or
+    varint  len << 1 | DELTA_COPY, followed by a zigzag varint saying how far
+            the copied bytes are from where the previous copy left off (plus
+            any literal bytes since), which for data that was just edited in
+            place is 0.
+*/
+
+#define DELTA_FORMAT  1
+#define DELTA_COPY    0
+#define DELTA_LITERAL 1
+
+// Copies shorter than this aren't looked for.
+static const size_t BLOCK = 16;
+
+static void _put_varint(vector<unsigned char> &out, uint64_t x)
+{
+    while (x >= 0x80)
+    {
+        out.push_back(x | 0x80);
+        x >>= 7;
+    }
+    out.push_back(x);
+}
+
+static uint64_t _get_varint(const vector<unsigned char> &in, size_t &at)
+{
+    uint64_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (at >= in.size())
+            break;
+        const unsigned char b = in[at++];
+        x |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return x;
+    }
+    corrupted("save file corrupted -- bad chunk delta");
+}
+
+static uint64_t _block_hash(const unsigned char *p)
+{
+    uint64_t a, b;
+    memcpy(&a, p, sizeof(a));
+    memcpy(&b, p + sizeof(a), sizeof(b));
+    return (a * 0x9E3779B97F4A7C15ULL ^ b) * 0xC2B2AE3D27D4EB4FULL;
+}
+
+static uint64_t _checksum(const vector<unsigned char> &data)
+{
+    uint64_t sum = data.size();
+    size_t at = 0;
+    for (; at + BLOCK <= data.size(); at += BLOCK)
+        sum = (sum ^ _block_hash(&data[at])) * 0x100000001B3ULL;
+    for (; at < data.size(); ++at)
+        sum = (sum ^ data[at]) * 0x100000001B3ULL;
+    return sum;
+}
+
+static void _put_literal(vector<unsigned char> &out,
+                         const vector<unsigned char> &now,
+                         size_t from, size_t to)
+{
+    if (from == to)
+        return;
+    _put_varint(out, (to - from) << 1 | DELTA_LITERAL);
+    out.insert(out.end(), now.begin() + from, now.begin() + to);
+}
+
+bool make_chunk_delta(const vector<unsigned char> &base,
+                      const vector<unsigned char> &now,
+                      vector<unsigned char> &delta, size_t limit)
+{
+    delta.clear();
+    delta.push_back(DELTA_FORMAT);
+    _put_varint(delta, base.size());
+    _put_varint(delta, _checksum(base));
+    _put_varint(delta, now.size());
+
+    // The first occurrence of every aligned block of the base.
+    std::unordered_map<uint64_t, size_t> blocks;
+    blocks.reserve(base.size() / BLOCK);
+    for (size_t at = 0; at + BLOCK <= base.size(); at += BLOCK)
+        blocks.emplace(_block_hash(&base[at]), at);
+
+    size_t literal = 0; // start of the bytes not yet covered
+    size_t expect = 0;  // where in the base the last copy ended
+    size_t i = 0;
+    while (i + BLOCK <= now.size())
+    {
+        if (delta.size() + (i - literal) > limit)
+            return false;
+
+        // Most changes are edits in place, so first try where the bytes
+        // would be if nothing had moved.
+        size_t from = expect + (i - literal);
+        if (from + BLOCK > base.size()
+            || memcmp(&now[i], &base[from], BLOCK))
+        {
+            auto bl = blocks.find(_block_hash(&now[i]));
+            if (bl == blocks.end()
+                || memcmp(&now[i], &base[bl->second], BLOCK))
+            {
+                ++i;
+                continue;
+            }
+            from = bl->second;
+        }
+
+        // Grow the match in both directions.
+        while (i > literal && from > 0 && now[i - 1] == base[from - 1])
+            --i, --from;
+        size_t len = BLOCK;
+        while (i + len < now.size() && from + len < base.size()
+               && now[i + len] == base[from + len])
+        {
+            ++len;
+        }
+
+        _put_literal(delta, now, literal, i);
+        const int64_t skip = (int64_t)from - (int64_t)(expect + (i - literal));
+        _put_varint(delta, len << 1 | DELTA_COPY);
+        _put_varint(delta, (uint64_t)skip << 1 ^ (uint64_t)(skip >> 63));
+
+        i += len;
+        literal = i;
+        expect = from + len;
+    }
+    _put_literal(delta, now, literal, now.size());
+
+    return delta.size() <= limit;
+}
+
+void apply_chunk_delta(const vector<unsigned char> &base,
+                       const vector<unsigned char> &delta,
+                       vector<unsigned char> &out)
+{
+    size_t at = 0;
+    if (delta.empty() || delta[at++] != DELTA_FORMAT)
+        corrupted("save file corrupted -- unknown chunk delta format");
+    if (_get_varint(delta, at) != base.size()
+        || _get_varint(delta, at) != _checksum(base))
+    {
+        corrupted("save file corrupted -- chunk delta for another base");
+    }
+    const uint64_t size = _get_varint(delta, at);
+
+    out.clear();
+    out.reserve(size);
+    size_t expect = 0;
+    size_t literal = 0;
+    while (at < delta.size())
+    {
+        const uint64_t op = _get_varint(delta, at);
+        const uint64_t len = op >> 1;
+        if (len > size - out.size())
+            corrupted("save file corrupted -- chunk delta overflow");
+
+        if ((op & 1) == DELTA_LITERAL)
+        {
+            if (len > delta.size() - at)
+                corrupted("save file corrupted -- truncated chunk delta");
+            out.insert(out.end(), delta.begin() + at, delta.begin() + at + len);
+            at += len;
+            literal += len;
+            continue;
+        }
+
+        const uint64_t zz = _get_varint(delta, at);
+        const int64_t skip = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+        const int64_t from = (int64_t)(expect + literal) + skip;
+        if (from < 0 || (uint64_t)from > base.size()
+            || len > base.size() - from)
+        {
+            corrupted("save file corrupted -- chunk delta out of range");
+        }
+        out.insert(out.end(), base.begin() + from, base.begin() + from + len);
+        expect = from + len;
+        literal = 0;
+    }
+
+    if (out.size() != size)
+        corrupted("save file corrupted -- truncated chunk delta");
+}
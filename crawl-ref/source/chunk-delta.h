@@ -0,0 +1,22 @@
+/**
+ * @file
+ * @brief Describing a save chunk as its differences to an older version.
+**/
+
+#pragma once
+
+#include <vector>
+
+using std::vector;
+
+// Encode `now` as a list of copies from `base` and literal bytes. Gives up,
+// returning false, once the delta would grow past `limit` bytes.
+bool make_chunk_delta(const vector<unsigned char> &base,
+                      const vector<unsigned char> &now,
+                      vector<unsigned char> &delta, size_t limit);
+
+// Rebuild the chunk a delta was made from. Throws corrupted_save if the
+// delta doesn't fit the base.
+void apply_chunk_delta(const vector<unsigned char> &base,
+                       const vector<unsigned char> &delta,
+                       vector<unsigned char> &out);
@@ -7,6 +7,13 @@
 
 #include "dbg-maps.h"
 
+#include <cerrno>
+#include <cinttypes>
+#if defined(UNIX)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "branch.h"
 #include "chardump.h"
 #include "crash.h"
@@ -22,7 +29,9 @@
 #include "shopping.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "tag-version.h"
+#include "tags.h"
 #include "view.h"
 
 #ifdef DEBUG_STATISTICS
@@ -47,6 +56,9 @@ static int build_attempts = 0, level_vetoes = 0;
 // Map from message to counts.
 static map<string, int> veto_messages;
 
+// Set in -jobs worker processes, which leave the display to the parent.
+static bool in_stat_job = false;
+
 void mapstat_report_map_build_start()
 {
     build_attempts++;
@@ -74,19 +86,22 @@ static bool _is_disconnected_level()
 
 static bool _do_build_level()
 {
-    clear_messages();
-    mprf("On %s; %d g, %d fail, %u err%s, %u uniq, "
-         "%d try, %d (%.2f%%) vetos",
-         level_id::current().describe().c_str(), levels_tried, levels_failed,
-         (unsigned int)errors.size(), last_error.empty() ? ""
-         : (" (" + last_error + ")").c_str(), (unsigned int) use_count.size(),
-         build_attempts, level_vetoes,
-         build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
+    if (!in_stat_job)
+    {
+        clear_messages();
+        mprf("On %s; %d g, %d fail, %u err%s, %u uniq, "
+             "%d try, %d (%.2f%%) vetos",
+             level_id::current().describe().c_str(), levels_tried,
+             levels_failed, (unsigned int)errors.size(), last_error.empty()
+             ? "" : (" (" + last_error + ")").c_str(),
+             (unsigned int) use_count.size(), build_attempts, level_vetoes,
+             build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
+    }
 
     watchdog();
 
     msg::suppress mx;
-    if (kbhit() && key_is_escape(getch_ck()))
+    if (!in_stat_job && kbhit() && key_is_escape(getch_ck()))
     {
         mprf(MSGCH_WARN, "User requested cancel");
         return false;
@@ -230,11 +245,257 @@ static bool _build_dungeon()
     return true;
 }
 
+static bool _build_iteration(int iter)
+{
+    if (!in_stat_job)
+    {
+        clear_messages();
+        mprf("On %d of %d; %d g, %d fail, %u err%s, %u uniq, "
+             "%d try, %d (%.2f%%) vetoes",
+             iter, SysEnv.map_gen_iters, levels_tried, levels_failed,
+             (unsigned int)errors.size(),
+             last_error.empty() ? "" : (" (" + last_error + ")").c_str(),
+             (unsigned int)use_count.size(), build_attempts, level_vetoes,
+             build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
+    }
+    printf("%d..", iter + 1);
+    fflush(stdout);
+
+    // Every iteration gets its own seed, so that a given iteration builds
+    // the same dungeon no matter which job it ends up in.
+    rng::seed(crawl_state.seed + iter);
+
+    dlua.callfn("dgn_clear_data", "");
+    you.uniq_map_tags.clear();
+    you.uniq_map_names.clear();
+    you.uniq_map_tags_abyss.clear();
+    you.uniq_map_names_abyss.clear();
+    you.unique_creatures.reset();
+    initialise_branch_depths();
+    init_level_connectivity();
+    if (!_build_dungeon())
+        return false;
+    if (crawl_state.obj_stat_gen)
+        objstat_iteration_stats();
+    return true;
+}
+
+#ifdef UNIX
+static string _job_stat_file(int job)
+{
+    return make_stringf("mapstat-job%d.tmp", job);
+}
+
+static void _save_job_stats(writer &th)
+{
+    marshallInt(th, levels_tried);
+    marshallInt(th, levels_failed);
+    marshallInt(th, build_attempts);
+    marshallInt(th, level_vetoes);
+    marshallString(th, last_error);
+
+    for (const auto *counts : { &try_count, &use_count, &success_count,
+                                &veto_messages })
+    {
+        marshallInt(th, counts->size());
+        for (const auto &entry : *counts)
+        {
+            marshallString(th, entry.first);
+            marshallInt(th, entry.second);
+        }
+    }
+
+    marshallInt(th, errors.size());
+    for (const auto &entry : errors)
+    {
+        marshallString(th, entry.first);
+        marshallString(th, entry.second);
+    }
+
+    marshallInt(th, level_mapcounts.size());
+    for (const auto &entry : level_mapcounts)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+
+    marshallInt(th, map_builds.size());
+    for (const auto &entry : map_builds)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second.first);
+        marshallInt(th, entry.second.second);
+    }
+
+    marshallInt(th, level_mapsused.size());
+    for (const auto &entry : level_mapsused)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const string &name : entry.second)
+            marshallString(th, name);
+    }
+
+    marshallInt(th, map_levelsused.size());
+    for (const auto &entry : map_levelsused)
+    {
+        marshallString(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const level_id &lid : entry.second)
+            marshall_level_id(th, lid);
+    }
+
+    if (crawl_state.obj_stat_gen)
+        objstat_save_job_stats(th);
+}
+
+static void _merge_job_stats(reader &th)
+{
+    levels_tried += unmarshallInt(th);
+    levels_failed += unmarshallInt(th);
+    build_attempts += unmarshallInt(th);
+    level_vetoes += unmarshallInt(th);
+    const string job_error = unmarshallString(th);
+    if (!job_error.empty())
+        last_error = job_error;
+
+    for (auto *counts : { &try_count, &use_count, &success_count,
+                          &veto_messages })
+    {
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            const string key = unmarshallString(th);
+            (*counts)[key] += unmarshallInt(th);
+        }
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const string map_name = unmarshallString(th);
+        errors[map_name] = unmarshallString(th);
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const level_id lid = unmarshall_level_id(th);
+        level_mapcounts[lid] += unmarshallInt(th);
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const level_id lid = unmarshall_level_id(th);
+        map_builds[lid].first += unmarshallInt(th);
+        map_builds[lid].second += unmarshallInt(th);
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        set<string> &maps = level_mapsused[unmarshall_level_id(th)];
+        for (int j = unmarshallInt(th); j > 0; --j)
+            maps.insert(unmarshallString(th));
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        set<level_id> &levels = map_levelsused[unmarshallString(th)];
+        for (int j = unmarshallInt(th); j > 0; --j)
+            levels.insert(unmarshall_level_id(th));
+    }
+
+    if (crawl_state.obj_stat_gen)
+        objstat_merge_job_stats(th);
+}
+
+/**
+ * Split the iterations between SysEnv.map_gen_jobs forked worker processes.
+ * Each worker builds every Nth iteration and writes its stats to a temporary
+ * file, which we merge into our own once it is done.
+ *
+ * @returns True if every worker built all of its iterations successfully.
+ */
+static bool _build_levels_in_jobs()
+{
+    const int jobs = min(SysEnv.map_gen_jobs, SysEnv.map_gen_iters);
+    vector<pid_t> workers;
+
+    for (int job = 0; job < jobs; ++job)
+    {
+        // Don't let the workers inherit (and later flush) buffered output.
+        fflush(stdout);
+        fflush(stderr);
+
+        const pid_t pid = fork();
+        if (pid == -1)
+        {
+            fprintf(stderr, "Couldn't fork a mapstat job: %s\n",
+                    strerror(errno));
+            break;
+        }
+        else if (!pid)
+        {
+            in_stat_job = true;
+            bool success = true;
+            for (int i = job; success && i < SysEnv.map_gen_iters; i += jobs)
+                success = _build_iteration(i);
+
+            const string file = _job_stat_file(job);
+            FILE *fp = fopen_u(file.c_str(), "wb");
+            if (!fp)
+                _exit(1);
+            {
+                writer outf(file, fp);
+                marshallBoolean(outf, success);
+                _save_job_stats(outf);
+                if (!outf.succeeded())
+                    success = false;
+            }
+            if (fclose(fp))
+                success = false;
+            fflush(stdout);
+            // Skip the exit handlers, they belong to the parent.
+            _exit(success ? 0 : 1);
+        }
+        workers.push_back(pid);
+    }
+
+    bool success = (int) workers.size() == jobs;
+    for (int job = 0; job < (int) workers.size(); ++job)
+    {
+        int status;
+        if (waitpid(workers[job], &status, 0) == -1
+            || !WIFEXITED(status) || WEXITSTATUS(status))
+        {
+            success = false;
+        }
+
+        const string file = _job_stat_file(job);
+        FILE *fp = fopen_u(file.c_str(), "rb");
+        if (!fp)
+        {
+            fprintf(stderr, "Mapstat job %d left no stats.\n", job);
+            success = false;
+            continue;
+        }
+        {
+            reader inf(fp);
+            if (!unmarshallBoolean(inf))
+                success = false;
+            _merge_job_stats(inf);
+        }
+        fclose(fp);
+        unlink_u(file.c_str());
+    }
+    return success;
+}
+#endif
+
 /**
  * Build dungeon levels for mapstat or objstat.
  *
  * The exact branches/levels built and number of build iterations is set by the
- * command-line options for mapstat/objstat.
+ * command-line options for mapstat/objstat. Iteration i is always built from
+ * the seed (game seed + i), so results are reproducible with -seed and don't
+ * depend on the number of -jobs.
 
  * @returns True if all iterations built successfully. For mapstat, this can
  * return false if an iteration produced a disconnected level, since for
@@ -247,33 +508,25 @@ bool mapstat_build_levels()
 {
     if (!generated_levels.size())
         _dungeon_places();
+
+    rng::reset();
+    printf("Using seed %" PRIu64 ".\n", crawl_state.seed);
     printf("Iteration: ");
     fflush(stdout);
-    for (int i = 0; i < SysEnv.map_gen_iters; ++i)
+
+#ifdef UNIX
+    if (SysEnv.map_gen_jobs > 1)
     {
-        clear_messages();
-        mprf("On %d of %d; %d g, %d fail, %u err%s, %u uniq, "
-             "%d try, %d (%.2f%%) vetoes",
-             i, SysEnv.map_gen_iters, levels_tried, levels_failed,
-             (unsigned int)errors.size(),
-             last_error.empty() ? "" : (" (" + last_error + ")").c_str(),
-             (unsigned int)use_count.size(), build_attempts, level_vetoes,
-             build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
-        printf("%d..", i + 1);
+        const bool success = _build_levels_in_jobs();
+        printf("Finished.\n");
         fflush(stdout);
-        dlua.callfn("dgn_clear_data", "");
-        you.uniq_map_tags.clear();
-        you.uniq_map_names.clear();
-        you.uniq_map_tags_abyss.clear();
-        you.uniq_map_names_abyss.clear();
-        you.unique_creatures.reset();
-        initialise_branch_depths();
-        init_level_connectivity();
-        if (!_build_dungeon())
-            return false;
-        if (crawl_state.obj_stat_gen)
-            objstat_iteration_stats();
+        return success;
     }
+#endif
+
+    for (int i = 0; i < SysEnv.map_gen_iters; ++i)
+        if (!_build_iteration(i))
+            return false;
     printf("Finished.\n");
     fflush(stdout);
     return true;
@@ -338,6 +591,8 @@ static void _write_map_stats()
     printf("Writing map stats to %s...", out_file);
     fflush(stdout);
     fprintf(outf, "Map Generation Stats\n\n");
+    fprintf(outf, "Seed: %" PRIu64 ", iterations: %d\n", crawl_state.seed,
+            SysEnv.map_gen_iters);
     fprintf(outf, "Levels attempted: %d, built: %d, failed: %d\n",
             levels_tried, levels_tried - levels_failed,
             levels_failed);
@@ -36,6 +36,7 @@
 #include "stepdown.h"
 #include "stringutil.h"
 #include "tag-version.h"
+#include "tags.h"
 #include "version.h"
 
 #ifdef DEBUG_STATISTICS
@@ -878,6 +879,228 @@ void objstat_iteration_stats()
     }
 }
 
+// Job stats are only ever read back by the process that forked the job, so
+// doubles can be stored in their native representation.
+static void _marshall_stat_value(writer &th, double value)
+{
+    th.write(&value, sizeof(value));
+}
+
+static double _unmarshall_stat_value(reader &th)
+{
+    double value;
+    th.read(&value, sizeof(value));
+    return value;
+}
+
+// Can't use marshall_level_id(), which doesn't round-trip the depth -1
+// summary levels.
+static void _marshall_stat_level(writer &th, const level_id &lev)
+{
+    marshallInt(th, lev.branch);
+    marshallInt(th, lev.depth);
+}
+
+static level_id _unmarshall_stat_level(reader &th)
+{
+    const branch_type br = static_cast<branch_type>(unmarshallInt(th));
+    const int depth = unmarshallInt(th);
+    return level_id(br, depth);
+}
+
+static void _marshall_stats(writer &th, const map<string, double> &stats)
+{
+    marshallInt(th, stats.size());
+    for (const auto &entry : stats)
+    {
+        marshallString(th, entry.first);
+        _marshall_stat_value(th, entry.second);
+    }
+}
+
+// Everything is a sum over iterations except for the per-iteration extremes.
+static void _merge_stats(reader &th, map<string, double> &stats)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const string field = unmarshallString(th);
+        const double value = _unmarshall_stat_value(th);
+
+        auto stat = stats.find(field);
+        if (stat == stats.end())
+            stats[field] = value;
+        else if (ends_with(field, "Min"))
+            stat->second = min(stat->second, value);
+        else if (ends_with(field, "Max"))
+            stat->second = max(stat->second, value);
+        else
+            stat->second += value;
+    }
+}
+
+static void _marshall_counts(writer &th, const vector<int> &counts)
+{
+    marshallInt(th, counts.size());
+    for (int count : counts)
+        marshallInt(th, count);
+}
+
+static void _merge_counts(reader &th, vector<int> &counts)
+{
+    const int size = unmarshallInt(th);
+    if ((int) counts.size() < size)
+        counts.resize(size, 0);
+    for (int i = 0; i < size; ++i)
+        counts[i] += unmarshallInt(th);
+}
+
+static void _marshall_brands(writer &th, const brand_records &brands)
+{
+    marshallInt(th, brands.size());
+    for (const auto &entry : brands)
+    {
+        _marshall_stat_level(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const auto &sub_type : entry.second)
+        {
+            marshallInt(th, sub_type.size());
+            for (const auto &counts : sub_type)
+                _marshall_counts(th, counts);
+        }
+    }
+}
+
+static void _merge_brands(reader &th, brand_records &brands)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        auto &lev_brands = brands[_unmarshall_stat_level(th)];
+        const int num_sub_types = unmarshallInt(th);
+        if ((int) lev_brands.size() < num_sub_types)
+            lev_brands.resize(num_sub_types);
+        for (int j = 0; j < num_sub_types; ++j)
+        {
+            const int num_antiqs = unmarshallInt(th);
+            if ((int) lev_brands[j].size() < num_antiqs)
+                lev_brands[j].resize(num_antiqs);
+            for (int k = 0; k < num_antiqs; ++k)
+                _merge_counts(th, lev_brands[j][k]);
+        }
+    }
+}
+
+/**
+ * Write out everything recorded so far, for a -jobs worker process to hand
+ * its stats back to the parent.
+ */
+void objstat_save_job_stats(writer &th)
+{
+    marshallInt(th, item_recs.size());
+    for (const auto &entry : item_recs)
+    {
+        _marshall_stat_level(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const auto &base_type : entry.second)
+        {
+            marshallInt(th, base_type.size());
+            for (const auto &stats : base_type)
+                _marshall_stats(th, stats);
+        }
+    }
+
+    _marshall_brands(th, weapon_brands);
+    _marshall_brands(th, armour_brands);
+
+    marshallInt(th, missile_brands.size());
+    for (const auto &entry : missile_brands)
+    {
+        _marshall_stat_level(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const auto &counts : entry.second)
+            _marshall_counts(th, counts);
+    }
+
+    marshallInt(th, monster_recs.size());
+    for (const auto &entry : monster_recs)
+    {
+        _marshall_stat_level(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const auto &mons : entry.second)
+        {
+            marshallInt(th, mons.first);
+            _marshall_stats(th, mons.second);
+        }
+    }
+
+    marshallInt(th, feature_recs.size());
+    for (const auto &entry : feature_recs)
+    {
+        _marshall_stat_level(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const auto &feat : entry.second)
+        {
+            marshallInt(th, feat.first);
+            _marshall_stats(th, feat.second);
+        }
+    }
+}
+
+/**
+ * Add the stats written by objstat_save_job_stats() to our own.
+ */
+void objstat_merge_job_stats(reader &th)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        auto &lev_recs = item_recs[_unmarshall_stat_level(th)];
+        const int num_base_types = unmarshallInt(th);
+        if ((int) lev_recs.size() < num_base_types)
+            lev_recs.resize(num_base_types);
+        for (int j = 0; j < num_base_types; ++j)
+        {
+            const int num_entries = unmarshallInt(th);
+            if ((int) lev_recs[j].size() < num_entries)
+                lev_recs[j].resize(num_entries);
+            for (int k = 0; k < num_entries; ++k)
+                _merge_stats(th, lev_recs[j][k]);
+        }
+    }
+
+    _merge_brands(th, weapon_brands);
+    _merge_brands(th, armour_brands);
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        auto &lev_brands = missile_brands[_unmarshall_stat_level(th)];
+        const int num_sub_types = unmarshallInt(th);
+        if ((int) lev_brands.size() < num_sub_types)
+            lev_brands.resize(num_sub_types);
+        for (int j = 0; j < num_sub_types; ++j)
+            _merge_counts(th, lev_brands[j]);
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        auto &lev_recs = monster_recs[_unmarshall_stat_level(th)];
+        for (int j = unmarshallInt(th); j > 0; --j)
+        {
+            const int mons_ind = unmarshallInt(th);
+            _merge_stats(th, lev_recs[mons_ind]);
+        }
+    }
+
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        auto &lev_recs = feature_recs[_unmarshall_stat_level(th)];
+        for (int j = unmarshallInt(th); j > 0; --j)
+        {
+            const auto feat = static_cast<dungeon_feature_type>(
+                                                        unmarshallInt(th));
+            _merge_stats(th, lev_recs[feat]);
+        }
+    }
+}
+
 static void _write_stat_headers(const vector<string> &fields, string desc)
 {
     fprintf(stat_outf, "%s\tLevel", desc.c_str());
@@ -330,6 +330,12 @@ void debug_mons_scan()
         ASSERT(m->mid > 0);
         coord_def pos = m->pos();
 
+        if (!binary_search(env.mons_slots.begin(), env.mons_slots.end(), i))
+        {
+            mprf(MSGCH_ERROR, "Monster %s (midx = %d) missing from the slot "
+                              "index", m->full_name(DESC_PLAIN).c_str(), i);
+        }
+
         if (invalid_monster_type(m->type))
         {
             mprf(MSGCH_ERROR, "Bogus monster type %d at (%d, %d), midx = %d",
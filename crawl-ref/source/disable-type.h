@@ -12,5 +12,6 @@ enum disable_type
     DIS_AFFLICTIONS,
     DIS_MON_SIGHT,
     DIS_SAVE_CHECKPOINTS,
+    DIS_DISPLAY,
     NUM_DISABLEMENTS
 };
@@ -790,19 +790,21 @@ static void _set_grd(const coord_def &c, dungeon_feature_type feat)
     env.grid(c) = feat;
 }
 
-static void _dgn_register_vault(const string &name, const unordered_set<string> &tags)
+static void _dgn_register_vault(const string &name,
+                                const vector<intern_id> &tag_ids)
 {
-    if (!tags.count("allow_dup"))
+    static const intern_id allow_dup = intern_string("allow_dup");
+    static const intern_id luniq = intern_string("luniq");
+
+    if (find(tag_ids.begin(), tag_ids.end(), allow_dup) == tag_ids.end())
         get_uniq_map_names().insert(name);
 
-    if (tags.count("luniq"))
+    if (find(tag_ids.begin(), tag_ids.end(), luniq) != tag_ids.end())
         env.level_uniq_maps.insert(name);
 
-    vector<string> sorted_tags(tags.begin(), tags.end());
-    sort(sorted_tags.begin(), sorted_tags.end());
-
-    for (const string &tag : sorted_tags)
+    for (intern_id id : tag_ids)
     {
+        const string &tag = interned_string(id);
         if (starts_with(tag, "uniq_"))
             get_uniq_map_tags().insert(tag);
         else if (starts_with(tag, "luniq_"))
@@ -812,12 +814,15 @@ static void _dgn_register_vault(const string &name, const unordered_set<string>
 
 static void _dgn_register_vault(const map_def &map)
 {
-    _dgn_register_vault(map.name, map.get_tags_unsorted());
+    _dgn_register_vault(map.name, map.get_tag_ids());
 }
 
 static void _dgn_register_vault(const string &name, string &spaced_tags)
 {
-    _dgn_register_vault(name, parse_tags(spaced_tags));
+    vector<intern_id> tag_ids;
+    for (const string &tag : parse_tags(spaced_tags))
+        tag_ids.push_back(intern_string(tag));
+    _dgn_register_vault(name, tag_ids);
 }
 
 static void _dgn_unregister_vault(const map_def &map)
@@ -825,8 +830,9 @@ static void _dgn_unregister_vault(const map_def &map)
     get_uniq_map_names().erase(map.name);
     env.level_uniq_maps.erase(map.name);
 
-    for (const string &tag : map.get_tags_unsorted())
+    for (intern_id id : map.get_tag_ids())
     {
+        const string &tag = interned_string(id);
         if (starts_with(tag, "uniq_"))
             get_uniq_map_tags().erase(tag);
         else if (starts_with(tag, "luniq_"))
@@ -1247,9 +1253,9 @@ dgn_register_place(const vault_placement &place, bool register_vault)
     }
 
     // Find tags matching properties.
-    for (const auto &tag : place.map.get_tags_unsorted())
+    for (intern_id tag : place.map.get_tag_ids())
     {
-        const feature_property_type prop = str_to_fprop(tag);
+        const feature_property_type prop = str_to_fprop(interned_string(tag));
         if (prop == FPROP_NONE)
             continue;
 
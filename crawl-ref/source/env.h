@@ -106,6 +106,11 @@ struct crawl_environment
     // Mapping mid->mindex until the transition is finished.
     map<mid_t, unsigned short> mid_cache;
 
+    // The env.mons slots handed out since the last prune_monster_slots(),
+    // in order: every live monster is in here, so the monster iterators
+    // can skip the hundreds of empty slots.
+    vector<unsigned short> mons_slots;
+
     // Things to happen when the current attack/etc finishes.
     vector<final_effect *> final_effects;
 
@@ -40,6 +40,7 @@
 #include "areas.h"
 #include "branch.h"
 #include "chardump.h"
+#include "chunk-delta.h"
 #include "cloud.h"
 #include "coordit.h"
 #include "dactions.h"
@@ -130,6 +131,8 @@ static bool _ghost_version_compatible(const save_version &version);
 
 static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint);
+static bool _restore_tagged_reader(reader &inf, const string &name,
+                                   tag_type tag, const char* complaint);
 static bool _read_char_chunk(package *save);
 
 static bool _convert_obsolete_species();
@@ -1016,6 +1019,83 @@ static void _write_tagged_chunk(const string &chunkname, tag_type tag)
     tag_write(tag, outf);
 }
 
+// A level that is saved again after being loaded is usually stored as a
+// delta against its full chunk, in a chunk of its own. The full chunk is only
+// rewritten (and the delta dropped) once the delta grows past a fraction of
+// the level. This is the full chunk that was last read or written.
+static string level_base_name;
+static vector<unsigned char> level_base;
+
+static string _level_delta_name(const string &level_name)
+{
+    return level_name + "~";
+}
+
+static void _forget_level_base()
+{
+    level_base_name.clear();
+    level_base.clear();
+}
+
+static void _read_whole_chunk(const string &name, vector<unsigned char> &data)
+{
+    vector<char> buf;
+    chunk_reader inf(you.save, name);
+    inf.read_all(buf);
+    data.assign(buf.begin(), buf.end());
+}
+
+static void _write_level_chunk(const string &level_name)
+{
+    vector<unsigned char> buf;
+    {
+        writer outf(&buf);
+        write_save_version(outf, save_version::current());
+        tag_write(TAG_LEVEL, outf);
+    }
+
+    const string delta_name = _level_delta_name(level_name);
+    vector<unsigned char> delta;
+    if (level_name == level_base_name && you.save->has_chunk(level_name)
+        && make_chunk_delta(level_base, buf, delta, buf.size() / 16))
+    {
+        writer outf(you.save, delta_name);
+        outf.write(&delta[0], delta.size());
+        return;
+    }
+
+    {
+        writer outf(you.save, level_name);
+        outf.write(&buf[0], buf.size());
+    }
+    if (you.save->has_chunk(delta_name))
+        you.save->delete_chunk(delta_name);
+    level_base_name = level_name;
+    level_base = move(buf);
+}
+
+static void _restore_level_chunk(const string &level_name)
+{
+    vector<unsigned char> base;
+    _read_whole_chunk(level_name, base);
+
+    vector<unsigned char> level;
+    const string delta_name = _level_delta_name(level_name);
+    const bool has_delta = you.save->has_chunk(delta_name);
+    if (has_delta)
+    {
+        vector<unsigned char> delta;
+        _read_whole_chunk(delta_name, delta);
+        apply_chunk_delta(base, delta, level);
+    }
+    level_base_name = level_name;
+    level_base = move(base);
+
+    reader inf(has_delta ? level : level_base);
+    _restore_tagged_reader(inf, level_name, TAG_LEVEL,
+                           "Level file is invalid.");
+}
+
 static int _get_dest_stair_type(dungeon_feature_type stair_taken,
                                 bool &find_first)
 {
@@ -1671,8 +1751,7 @@ bool generate_level(const level_id &l)
         // the level generated before the portals.
         ASSERT(you.save->has_chunk(save_name));
         dprf("Reloading new level '%s'.", save_name.c_str());
-        _restore_tagged_chunk(you.save, save_name, TAG_LEVEL,
-            "Level file is invalid.");
+        _restore_level_chunk(save_name);
     }
     // Did the generation process actually manage to place the player? This is
     // a useful sanity check, and also is necessary for the initial loading
@@ -1696,6 +1775,15 @@ bool generate_level(const level_id &l)
 // rng for other branches anyways.
 //
 // How should this relate to logical_branch_order etc?
+//
+// Levels in this list can't be built concurrently, even though each branch
+// has its own levelgen rng (see rng-type.h): the builder works directly on
+// the global `env`, and every level reads and updates state that is shared
+// across the whole game -- unique creatures and unrands placed so far
+// (`you.unique_creatures`, `you.unique_items`), uniq vault tags and names,
+// and the dlua state used by vault code. The seed of any given level
+// therefore depends on every level generated before it in this order, and
+// changing either the order or the interleaving would break seed stability.
 static const vector<branch_type> branch_generation_order =
 {
     BRANCH_TEMPLE,
@@ -2040,7 +2128,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
         }
 
         dprf("Loading old level '%s'.", level_name.c_str());
-        _restore_tagged_chunk(you.save, level_name, TAG_LEVEL, "Level file is invalid.");
+        _restore_level_chunk(level_name);
         if (load_mode != LOAD_VISITOR)
             you.on_current_level = true;
         _redraw_all(); // TODO why is there a redraw call here?
@@ -2306,7 +2394,7 @@ void save_level(const level_id& lid)
     // Nail all items to the ground.
     fix_item_coordinates();
 
-    _write_tagged_chunk(lid.describe(), TAG_LEVEL);
+    _write_level_chunk(lid.describe());
 }
 
 #if TAG_MAJOR_VERSION == 34
@@ -2374,6 +2462,9 @@ static void _save_game_exit()
 
     clrscr();
 
+    // Don't claim the game is saved while it is still being written.
+    you.save->flush();
+
 #ifdef DGL_WHEREIS
     whereis_record("saved");
 #endif
@@ -2947,6 +3038,8 @@ static bool _restore_game(const string& filename)
 
     clear_message_store();
 
+    // Anything remembered about levels belongs to some earlier game.
+    _forget_level_base();
     you.save = new package((_get_savefile_directory() + filename).c_str(), true);
 
     if (!_read_char_chunk(you.save))
@@ -3073,6 +3166,9 @@ static bool _restore_game(const string& filename)
     // UI, which may not be safe if everything isn't fully loaded.
     check_selected_skills();
 
+    // From now on, saving the game shouldn't have to wait for the disk.
+    you.save->write_in_background();
+
     return true;
 }
 
@@ -3129,7 +3225,14 @@ void delete_level(const level_id &level)
     clear_level_annotations(level);
 
     if (you.save)
-        you.save->delete_chunk(level.describe());
+    {
+        const string level_name = level.describe();
+        you.save->delete_chunk(level_name);
+        if (you.save->has_chunk(_level_delta_name(level_name)))
+            you.save->delete_chunk(_level_delta_name(level_name));
+        if (level_name == level_base_name)
+            _forget_level_base();
+    }
 
     auto &visited = you.props[VISITED_LEVELS_KEY].get_table();
     visited.erase(level.describe());
@@ -3363,6 +3466,12 @@ static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint)
 {
     reader inf(save, name);
+    return _restore_tagged_reader(inf, name, tag, complaint);
+}
+
+static bool _restore_tagged_reader(reader &inf, const string &name,
+                                   tag_type tag, const char* complaint)
+{
     string reason;
     if (!_tagged_chunk_version_compatible(inf, &reason))
     {
@@ -3993,6 +3993,7 @@ enum commandline_option_type
     CLO_OBJSTAT,
     CLO_ITERATIONS,
     CLO_FORCE_MAP,
+    CLO_JOBS,
     CLO_ARENA,
     CLO_DUMP_MAPS,
     CLO_TEST,
@@ -4017,6 +4018,7 @@ enum commandline_option_type
     CLO_NO_GDB, CLO_NOGDB,
     CLO_THROTTLE,
     CLO_NO_THROTTLE,
+    CLO_HEADLESS,
     CLO_PLAYABLE_JSON, // JSON metadata for species, jobs, combos.
     CLO_BRANCHES_JSON, // JSON metadata for branches.
     CLO_SAVE_JSON,
@@ -4035,12 +4037,13 @@ static const char *cmd_ops[] =
 {
     "scores", "name", "species", "background", "dir", "rc", "rcdir", "tscores",
     "vscores", "scorefile", "morgue", "macro", "mapstat", "dump-disconnect",
-    "objstat", "iters", "force-map", "arena", "dump-maps", "test", "script",
+    "objstat", "iters", "force-map", "jobs", "arena", "dump-maps", "test",
+    "script",
     "builddb", "help", "version", "seed", "pregen", "save-version", "sprint",
     "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
     "print-charset", "tutorial", "wizard", "explore", "no-save", "gdb",
-    "no-gdb", "nogdb", "throttle", "no-throttle", "playable-json",
-    "branches-json", "save-json", "gametypes-json", "bones",
+    "no-gdb", "nogdb", "throttle", "no-throttle", "headless",
+    "playable-json", "branches-json", "save-json", "gametypes-json", "bones",
 #ifdef USE_TILE_WEB
     "webtiles-socket", "await-connection", "print-webtiles-options",
 #endif
@@ -4143,7 +4146,7 @@ static edit_command<es_command_type> es_commands[] =
     { ES_GET,     "get",     false, 1, 2, },
     { ES_PUT,     "put",     true,  1, 2, },
     { ES_RM,      "rm",      true,  1, 1, },
-    { ES_REPACK,  "repack",  false, 0, 0, },
+    { ES_REPACK,  "repack",  false, 0, 1, },
     { ES_INFO,    "info",    false, 0, 0, },
 };
 
@@ -4155,6 +4158,33 @@ static edit_command<eb_command_type> eb_commands[] =
     { EB_REWRITE,  "rewrite", true,  0, 1 },
 };
 
+static const char* package_codec_names[] =
+{
+    "zlib", "none",
+};
+COMPILE_CHECK(ARRAYSZ(package_codec_names) == NUM_PCODECS);
+
+// Parses "<codec>" or "zlib:<level>"; returns false if it's neither. The
+// level is left alone if there's none.
+static bool _parse_package_codec(const string &spec, package_codec &codec,
+                                 int &level)
+{
+    vector<string> parts = split_string(":", spec, true, true, 1);
+    if (parts.empty())
+        return false;
+    for (int i = 0; i < NUM_PCODECS; ++i)
+        if (parts[0] == package_codec_names[i])
+            codec = static_cast<package_codec>(i);
+    if (parts[0] != package_codec_names[codec])
+        return false;
+    if (parts.size() == 1)
+        return true;
+    if (codec != PCODEC_ZLIB)
+        return false;
+    level = atoi(parts[1].c_str());
+    return parts[1] == to_string(level) && level >= 0 && level <= 9;
+}
+
 #define FAIL(...) do { fprintf(stderr, __VA_ARGS__); return; } while (0)
 static void _edit_save(int argc, char **argv)
 {
@@ -4167,7 +4197,9 @@ static void _edit_save(int argc, char **argv)
                "  put <chunk> [<chunkfile>]   import a chunk from <chunkfile>\n"
                "     <chunkfile> defaults to \"chunk\"; use \"-\" for stdout/stdin\n"
                "  rm <chunk>                  delete a chunk\n"
-               "  repack                      defrag and reclaim unused space\n"
+               "  repack [<codec>]            defrag and reclaim unused space,\n"
+               "                              recompressing with <codec>: zlib,\n"
+               "                              zlib:<level 0-9> or none\n"
              );
         return;
     }
@@ -4270,7 +4302,19 @@ static void _edit_save(int argc, char **argv)
         }
         else if (cmd == ES_REPACK)
         {
+            package_codec codec = save.get_codec();
+            int level = -1;
+            if (argc == 3 && !_parse_package_codec(argv[2], codec, level))
+                FAIL("Unknown codec \"%s\".\n", argv[2]);
+#ifndef USE_ZLIB
+            if (codec == PCODEC_ZLIB)
+                FAIL("This build has no zlib support.\n");
+#endif
+
             package save2((filename + ".tmp").c_str(), true, true);
+            save2.set_codec(codec);
+            if (level >= 0)
+                save2.set_compression_level(level);
             for (const string &chunk : save.list_chunks())
             {
                 char buf[16384];
@@ -4293,6 +4337,7 @@ static void _edit_save(int argc, char **argv)
             plen_t frag = save.get_chunk_fragmentation("");
             plen_t flen = save.get_size();
             plen_t slack = save.get_slack();
+            printf("Codec: %s\n", package_codec_names[save.get_codec()]);
             printf("Chunks: (size compressed/uncompressed, fragments, name)\n");
             for (const string &chunk : list)
             {
@@ -4794,6 +4839,7 @@ bool parse_args(int argc, char **argv, bool rc_only)
 
     SysEnv.rcdirs.clear();
     SysEnv.map_gen_iters = 0;
+    SysEnv.map_gen_jobs = 1;
 
     if (argc < 2)           // no args!
         return true;
@@ -4971,6 +5017,24 @@ bool parse_args(int argc, char **argv, bool rc_only)
 #endif
             break;
 
+        case CLO_JOBS:
+#ifdef DEBUG_STATISTICS
+            if (!next_is_param || !isadigit(*next_arg))
+                end(1, false, "Integer argument required for -%s\n", arg);
+            else
+            {
+                SysEnv.map_gen_jobs = atoi(next_arg);
+                if (SysEnv.map_gen_jobs < 1)
+                    SysEnv.map_gen_jobs = 1;
+                else if (SysEnv.map_gen_jobs > 256)
+                    SysEnv.map_gen_jobs = 256;
+                nextUsed = true;
+            }
+#else
+            end(1, false, "%s", dbg_stat_err);
+#endif
+            break;
+
         case CLO_FORCE_MAP:
 #ifdef DEBUG_STATISTICS
             if (!next_is_param)
@@ -5268,6 +5332,20 @@ bool parse_args(int argc, char **argv, bool rc_only)
             crawl_state.throttle = false;
             break;
 
+        case CLO_HEADLESS:
+            crawl_state.disables.set(DIS_DISPLAY);
+            crawl_state.disables.set(DIS_DELAY);
+            if (!next_is_param)
+                break;
+
+            if (!sscanf(next_arg, "%d", &crawl_state.headless_turns)
+                || crawl_state.headless_turns < 0)
+            {
+                return false;
+            }
+            nextUsed = true;
+            break;
+
         case CLO_EXTRA_OPT_FIRST:
             if (!next_is_param)
                 return false;
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief Interned strings: small, stable handles for often-compared strings.
+ **/
+
+#include "AppHdr.h"
+
+#include "intern.h"
+
+#include <deque>
+#include <unordered_map>
+
+namespace
+{
+    struct intern_table
+    {
+        // A deque, so that growing it doesn't move the strings.
+        deque<string> strings;
+        unordered_map<string, intern_id> ids;
+    };
+
+    // Made on first use, so that static initialisers can intern strings.
+    intern_table &_table()
+    {
+        static intern_table table;
+        return table;
+    }
+}
+
+intern_id intern_string(const string &s)
+{
+    intern_table &table = _table();
+
+    auto found = table.ids.find(s);
+    if (found != table.ids.end())
+        return found->second;
+
+    const intern_id id = table.strings.size();
+    ASSERT(id != NO_INTERN);
+    table.strings.push_back(s);
+    table.ids.emplace(s, id);
+    return id;
+}
+
+intern_id lookup_interned(const string &s)
+{
+    const intern_table &table = _table();
+
+    auto found = table.ids.find(s);
+    return found == table.ids.end() ? NO_INTERN : found->second;
+}
+
+const string &interned_string(intern_id id)
+{
+    const intern_table &table = _table();
+
+    ASSERT(id < table.strings.size());
+    return table.strings[id];
+}
@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Interned strings: small, stable handles for often-compared strings.
+ **/
+
+#pragma once
+
+#include <climits>
+#include <string>
+
+using std::string;
+
+// A handle stays valid, and keeps naming the same string, for the rest of
+// the process. Handles are not stable between runs: save the string.
+typedef unsigned int intern_id;
+
+#define NO_INTERN UINT_MAX
+
+// Returns the handle for s, making one if need be.
+intern_id intern_string(const string &s);
+
+// Returns the handle for s, or NO_INTERN if it has never been interned;
+// unlike intern_string(), this never grows the table.
+intern_id lookup_interned(const string &s);
+
+const string &interned_string(intern_id id);
@@ -372,6 +372,7 @@ static const char* disablements[] =
     "afflictions",
     "mon_sight",
     "save_checkpoints",
+    "display",
 };
 
 LUAFN(debug_disable)
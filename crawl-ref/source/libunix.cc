@@ -825,7 +825,7 @@ void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
 void update_screen()
 {
     // In objstat and similar modes, there might not be a screen to update.
-    if (stdscr)
+    if (stdscr && !crawl_state.disables[DIS_DISPLAY])
     {
         // Refreshing the default colors helps keep colors synced in ttyrecs.
         curs_set_default_colors();
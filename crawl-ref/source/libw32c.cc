@@ -938,6 +938,8 @@ void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
 
 void update_screen()
 {
+    if (crawl_state.disables[DIS_DISPLAY])
+        return;
     bFlush();
 }
 
@@ -810,7 +810,7 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
+            dead_rays->or_and(*smoke_rays, *blockrays(*qi));
             *smoke_rays |= *blockrays(*qi);
             break;
         default:
@@ -59,6 +59,10 @@ static void _save_los(los_def* los, los_type l)
 }
 
 // Opacity at p has changed.
+//
+// Every cellray from o to q stays within the bounding box of o and q (see
+// los.cc), so p can only affect pairs whose bounding box contains it. The
+// cached entries of all other pairs around p are kept.
 void invalidate_los_around(const coord_def& p)
 {
     int x1 = max(p.x - LOS_MAX_RANGE, 0);
@@ -67,7 +71,26 @@ void invalidate_los_around(const coord_def& p)
     int y2 = min(p.y + LOS_MAX_RANGE, GYM - 1);
     for (int y = y1; y <= y2; y++)
         for (int x = x1; x <= x2; x++)
-            memset(globallos[x][y], 0, sizeof(halflos_t));
+        {
+            // The stored half always has the second cell at dx >= 0, and
+            // p is at (px, py) relative to (x, y), with px >= 0.
+            const int px = p.x - x;
+            const int py = p.y - y;
+            for (int dx = px; dx <= LOS_MAX_RANGE; dx++)
+            {
+                losfield_t* row = globallos[x][y][dx + o_half_x];
+                if (py >= 0)
+                {
+                    memset(row + py + o_half_y, 0,
+                           (LOS_MAX_RANGE - py + 1) * sizeof(losfield_t));
+                }
+                if (py <= 0)
+                {
+                    memset(row, 0,
+                           (py + o_half_y + 1) * sizeof(losfield_t));
+                }
+            }
+        }
 }
 
 void invalidate_los()
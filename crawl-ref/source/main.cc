@@ -375,6 +375,20 @@ static void _reset_game()
 #endif
 }
 
+// When the current game started, for -headless reports.
+static chrono::steady_clock::time_point _game_start_time;
+static int _game_start_turns = 0;
+
+static void _report_turn_rate()
+{
+    const chrono::duration<double> elapsed =
+        chrono::steady_clock::now() - _game_start_time;
+    const int turns = you.num_turns - _game_start_turns;
+    fprintf(stderr, "%d turns in %.1f seconds: %.1f turns per second\n",
+            turns, elapsed.count(),
+            elapsed.count() > 0 ? turns / elapsed.count() : 0.0);
+}
+
 static void _launch_game_loop()
 {
     bool game_ended = false;
@@ -389,6 +403,8 @@ static void _launch_game_loop()
         {
             game_ended = true;
             crawl_state.last_game_exit = ge;
+            if (crawl_state.disables[DIS_DISPLAY])
+                _report_turn_rate();
             _reset_game();
 
             // Don't re-enter the Sprint menu with restart_after_save, as
@@ -413,6 +429,9 @@ NORETURN static void _launch_game()
 {
     const bool game_start = startup_step();
 
+    _game_start_time = chrono::steady_clock::now();
+    _game_start_turns = you.num_turns;
+
     // Attach the macro key recorder
     remove_key_recorder(&repeat_again_rec);
     add_key_recorder(&repeat_again_rec);
@@ -503,6 +522,9 @@ static void _show_commandline_options_help()
     puts("  -sprint               select Sprint");
     puts("  -sprint-map <name>    preselect a Sprint map");
     puts("  -tutorial             select the Tutorial");
+    puts("  -headless [turns]     draw nothing and never wait for --more--, for");
+    puts("                        bot games; reports turns per second on stderr,");
+    puts("                        and exits without saving after [turns] turns");
 #ifdef WIZARD
     puts("  -wizard               allow access to wizard mode");
     puts("  -explore              allow access to explore mode");
@@ -559,6 +581,9 @@ static void _show_commandline_options_help()
     puts("      Defaults to entire dungeon; same level syntax as -mapstat.");
     puts("  -iters <num>        For -mapstat and -objstat, set the number of "
          "iterations");
+    puts("  -jobs <num>         For -mapstat and -objstat, split the "
+         "iterations between");
+    puts("      <num> worker processes");
     puts("  -force-map <map>    For -mapstat and -objstat, alway choose the "
          "      given map on every level.");
 #endif
@@ -2453,6 +2478,19 @@ void world_reacts()
         update_turn_count();
         msgwin_new_turn();
         crawl_state.lua_calls_no_turn = 0;
+        if (crawl_state.headless_turns
+            && you.num_turns - _game_start_turns >= crawl_state.headless_turns)
+        {
+            _report_turn_rate();
+            // Leave any save file as it was; ~player() insists that it be
+            // closed.
+            you.save->abort();
+            delete you.save;
+            you.save = nullptr;
+            end(0);
+        }
+        if (crawl_state.disables[DIS_DISPLAY] && !(you.num_turns % 1000))
+            _report_turn_rate();
         if (crawl_state.game_is_sprint()
             && !(you.num_turns % 256)
             && !you_are_delayed()
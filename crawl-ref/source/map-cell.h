@@ -57,6 +57,23 @@ struct cloud_info
     killer_type killer;
 };
 
+/*
+ * A snapshot of a monster, shared between every copy of the map_cell that
+ * took it: copying map knowledge (as webtiles does with the whole level on
+ * every update) then doesn't copy names, props, spells and inventory.
+ */
+struct shared_monster_info
+{
+    template<typename... Args>
+    explicit shared_monster_info(Args&&... args)
+        : info(std::forward<Args>(args)...), refs(1)
+    {
+    }
+
+    monster_info info;
+    int refs;
+};
+
 /*
  * A map_cell stores what the player knows about a cell.
  * These go in env.map_knowledge.
@@ -74,7 +91,7 @@ struct map_cell
         if (_cloud)
             _cloud = new cloud_info(*_cloud);
         if (_mons)
-            _mons = new monster_info(*_mons);
+            ++_mons->refs;
         if (_item)
             _item = new item_def(*_item);
     }
@@ -83,8 +100,7 @@ struct map_cell
     {
         if (_cloud)
             delete _cloud;
-        if (!(flags & MAP_DETECTED_MONSTER) && _mons)
-            delete _mons;
+        _release_monster();
         if (_item)
             delete _item;
     }
@@ -95,15 +111,14 @@ struct map_cell
             return *this;
         if (_cloud)
             delete _cloud;
-        if (_mons)
-            delete _mons;
+        _release_monster();
         if (_item)
             delete _item;
         memcpy(this, &c, sizeof(map_cell));
         if (_cloud)
             _cloud = new cloud_info(*_cloud);
         if (_mons)
-            _mons = new monster_info(*_mons);
+            ++_mons->refs;
         if (_item)
             _item = new item_def(*_item);
         return *this;
@@ -194,20 +209,39 @@ struct map_cell
     monster_type monster() const
     {
         if (_mons)
-            return _mons->type;
+            return _mons->info.type;
         else
             return MONS_NO_MONSTER;
     }
 
-    monster_info* monsterinfo() const
+    const monster_info* monsterinfo() const
     {
-        return _mons;
+        return _mons ? &_mons->info : nullptr;
+    }
+
+    // The monster_info of this cell alone, copying it first if other cells
+    // share it.
+    monster_info* mutable_monsterinfo()
+    {
+        if (_mons && _mons->refs > 1)
+        {
+            --_mons->refs;
+            _mons = new shared_monster_info(_mons->info);
+        }
+        return _mons ? &_mons->info : nullptr;
     }
 
     void set_monster(const monster_info& mi)
     {
         clear_monster();
-        _mons = new monster_info(mi);
+        _mons = new shared_monster_info(mi);
+    }
+
+    // Take a fresh snapshot of a monster the player can see.
+    void set_monster(const ::monster* mons)
+    {
+        clear_monster();
+        _mons = new shared_monster_info(mons);
     }
 
     bool detected_monster() const
@@ -223,8 +257,8 @@ struct map_cell
     void set_detected_monster(monster_type mons)
     {
         clear_monster();
-        _mons = new monster_info(MONS_SENSED);
-        _mons->base_type = mons;
+        _mons = new shared_monster_info(MONS_SENSED);
+        _mons->info.base_type = mons;
         flags |= MAP_DETECTED_MONSTER;
     }
 
@@ -236,8 +270,7 @@ struct map_cell
 
     void clear_monster()
     {
-        if (_mons)
-            delete _mons;
+        _release_monster();
         flags &= ~(MAP_DETECTED_MONSTER | MAP_INVISIBLE_MONSTER);
         _mons = 0;
     }
@@ -311,6 +344,13 @@ struct map_cell
         return _trap;
     }
 
+private:
+    void _release_monster()
+    {
+        if (_mons && --_mons->refs == 0)
+            delete _mons;
+    }
+
 public:
     uint32_t flags;   // Flags describing the mappedness of this square.
 private:
@@ -319,5 +359,5 @@ private:
     trap_type _trap:8;
     cloud_info* _cloud;
     item_def* _item;
-    monster_info* _mons;
+    shared_monster_info* _mons;
 };
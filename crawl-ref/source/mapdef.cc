@@ -2178,6 +2178,15 @@ bool depth_ranges::is_usable_in(const level_id &lid) const
     return any_matched;
 }
 
+// Whether is_usable_in() could be true for some level of the branch.
+bool depth_ranges::may_be_usable_in(branch_type br) const
+{
+    for (const level_range &lr : depths)
+        if (!lr.deny && (lr.branch == br || lr.branch == NUM_BRANCHES))
+            return true;
+    return false;
+}
+
 void depth_ranges::add_depths(const depth_ranges &other_depths)
 {
     depths.insert(depths.end(),
@@ -2790,9 +2799,9 @@ string map_def::validate_map_placeable()
     // Ok, the map wants to be placed by tag. In this case it should have
     // at least one tag that's not a map flag.
     bool has_selectable_tag = false;
-    for (const string &piece : tags)
+    for (intern_id piece : tags)
     {
-        if (_map_tag_is_selectable(piece))
+        if (_map_tag_is_selectable(interned_string(piece)))
         {
             has_selectable_tag = true;
             break;
@@ -3337,15 +3346,22 @@ bool map_def::has_tag(const string &tagwanted) const
 #ifdef DEBUG_TAG_PROFILING
     _profile_inc_tag(tagwanted);
 #endif
-    return tags.count(tagwanted) > 0;
+    // A string that was never interned can't be anyone's tag.
+    const intern_id id = lookup_interned(tagwanted);
+    return id != NO_INTERN && has_tag(id);
+}
+
+bool map_def::has_tag(intern_id tagwanted) const
+{
+    return binary_search(tags.begin(), tags.end(), tagwanted);
 }
 
 bool map_def::has_tag_prefix(const string &prefix) const
 {
     if (prefix.empty())
         return false;
-    for (const auto &tag : tags)
-        if (starts_with(tag, prefix))
+    for (intern_id tag : tags)
+        if (starts_with(interned_string(tag), prefix))
             return true;
     return false;
 }
@@ -3354,39 +3370,47 @@ bool map_def::has_tag_suffix(const string &suffix) const
 {
     if (suffix.empty())
         return false;
-    for (const auto &tag : tags)
-        if (ends_with(tag, suffix))
+    for (intern_id tag : tags)
+        if (ends_with(interned_string(tag), suffix))
             return true;
     return false;
 }
 
-const unordered_set<string> map_def::get_tags_unsorted() const
-{
-    return tags;
-}
-
 const vector<string> map_def::get_tags() const
 {
     // this might seem inefficient, but get_tags is not called very much; the
     // hotspot revealed by profiling is actually has_tag checks.
-    vector<string> result(tags.begin(), tags.end());
+    vector<string> result;
+    for (intern_id tag : tags)
+        result.push_back(interned_string(tag));
     sort(result.begin(), result.end());
     return result;
 }
 
 void map_def::add_tags(const string &tag)
 {
-    auto parsed_tags = parse_tags(tag);
-    tags.insert(parsed_tags.begin(), parsed_tags.end());
+    for (const string &t : parse_tags(tag))
+    {
+        const intern_id id = intern_string(t);
+        auto pos = lower_bound(tags.begin(), tags.end(), id);
+        if (pos == tags.end() || *pos != id)
+            tags.insert(pos, id);
+    }
     update_cached_tags();
 }
 
 bool map_def::remove_tags(const string &tag)
 {
     bool removed = false;
-    auto parsed_tags = parse_tags(tag);
-    for (auto &t : parsed_tags)
-        removed = tags.erase(t) || removed; // would iterator overload be ok?
+    for (const string &t : parse_tags(tag))
+    {
+        auto pos = lower_bound(tags.begin(), tags.end(), lookup_interned(t));
+        if (pos != tags.end() && interned_string(*pos) == t)
+        {
+            tags.erase(pos);
+            removed = true;
+        }
+    }
     update_cached_tags();
     return removed;
 }
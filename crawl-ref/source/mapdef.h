@@ -23,6 +23,7 @@
 #include "enum.h"
 #include "fprop.h"
 #include "god-type.h"
+#include "intern.h"
 #include "makeitem.h"
 #include "matrix.h"
 #include "mon-attitude-type.h"
@@ -976,6 +977,7 @@ public:
     void clear() { depths.clear(); }
     bool empty() const { return depths.empty(); }
     bool is_usable_in(const level_id &lid) const;
+    bool may_be_usable_in(branch_type br) const;
     void add_depth(const level_range &range) { depths.push_back(range); }
     void add_depths(const depth_ranges &other_ranges);
     string describe() const;
@@ -1156,7 +1158,9 @@ public:
     vector<subvault_place> subvault_places;
 
 private:
-    unordered_set<string>     tags;
+    // Interned, and sorted by handle. Maps are copied and asked about their
+    // tags a great deal during level generation.
+    vector<intern_id>         tags;
     // This map has been loaded from an index, and not fully realised.
     bool            index_only;
     mutable long    cache_offset;
@@ -1263,6 +1267,7 @@ public:
     bool is_overwritable_layout() const;
     bool is_extra_vault() const;
     bool has_tag(const string &tagwanted) const;
+    bool has_tag(intern_id tagwanted) const;
     bool has_tag_prefix(const string &tag) const;
     bool has_tag_suffix(const string &suffix) const;
 
@@ -1288,7 +1293,7 @@ public:
     }
 
     const vector<string> get_tags() const;
-    const unordered_set<string> get_tags_unsorted() const;
+    const vector<intern_id> &get_tag_ids() const { return tags; }
     void add_tags(const string &tag);
     void set_tags(const string &tag);
     bool remove_tags(const string &tag);
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <unordered_map>
 #include <sys/param.h>
 #include <sys/types.h>
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
@@ -761,6 +762,8 @@ mapref_vector find_maps_for_tag(const string &tag,
     return maps;
 }
 
+typedef vector<unsigned> vault_indices;
+
 struct map_selector
 {
 private:
@@ -775,6 +778,7 @@ private:
 public:
     bool accept(const map_def &md) const;
     void announce(const map_def *map) const;
+    const vault_indices *candidates() const;
 
     bool valid() const
     {
@@ -853,13 +857,17 @@ static bool _overflow_range(level_id place)
 
 bool map_selector::depth_selectable(const map_def &mapdef) const
 {
+    static const intern_id unrand = intern_string("unrand");
+    static const intern_id place_unique = intern_string("place_unique");
+    static const intern_id tutorial = intern_string("tutorial");
+
     return mapdef.is_usable_in(place)
            // Some tagged levels cannot be selected as random
            // maps in a specific depth:
            && !mapdef.has_tag_suffix("entry")
-           && !mapdef.has_tag("unrand")
-           && !mapdef.has_tag("place_unique")
-           && !mapdef.has_tag("tutorial")
+           && !mapdef.has_tag(unrand)
+           && !mapdef.has_tag(place_unique)
+           && !mapdef.has_tag(tutorial)
            && (!mapdef.has_tag_prefix("temple_")
                || !_overflow_range(place)
                   && mapdef.has_tag_prefix("uniq_altar_"))
@@ -876,6 +884,8 @@ static bool _is_extra_compatible(maybe_bool want_extra, bool have_extra)
 
 bool map_selector::accept(const map_def &mapdef) const
 {
+    static const intern_id dummy = intern_string("dummy");
+
     switch (sel)
     {
     case PLACE:
@@ -896,7 +906,7 @@ bool map_selector::accept(const map_def &mapdef) const
         const map_chance chance(mapdef.chance(place));
         return mapdef.is_minivault() == mini
                && _is_extra_compatible(extra, mapdef.is_extra_vault())
-               && (!chance.valid() || mapdef.has_tag("dummy"))
+               && (!chance.valid() || mapdef.has_tag(dummy))
                && depth_selectable(mapdef)
                && !mapdef.map_already_used();
     }
@@ -906,7 +916,7 @@ bool map_selector::accept(const map_def &mapdef) const
         const map_chance chance(mapdef.chance(place));
         // Only vaults with valid chance
         return chance.valid()
-               && !mapdef.has_tag("dummy")
+               && !mapdef.has_tag(dummy)
                && depth_selectable(mapdef)
                && _is_extra_compatible(extra, mapdef.is_extra_vault())
                && !mapdef.map_already_used();
@@ -966,7 +976,96 @@ string vault_chance_tag(const map_def &map)
     return "";
 }
 
-typedef vector<unsigned> vault_indices;
+// Maps that selectors could possibly accept, by branch and by tag, so that
+// they don't test every map each time. The lists keep vdefs order, so the
+// eligible maps (and the random rolls made over them) are the same as
+// without the index. Rebuilt whenever maps are added or reloaded.
+static struct
+{
+    bool valid = false;
+    FixedVector<vault_indices, NUM_BRANCHES> by_place;
+    FixedVector<vault_indices, NUM_BRANCHES> by_depth;
+    unordered_map<intern_id, vault_indices> by_tag;
+} map_index;
+
+static void _invalidate_map_index()
+{
+    map_index.valid = false;
+}
+
+// Maps with these tags are never picked by depth; see depth_selectable().
+static bool _never_depth_selectable(const map_def &mapdef)
+{
+    return mapdef.has_tag_suffix("entry")
+           || mapdef.has_tag("unrand")
+           || mapdef.has_tag("place_unique")
+           || mapdef.has_tag("tutorial");
+}
+
+static void _build_map_index()
+{
+    for (int br = 0; br < NUM_BRANCHES; ++br)
+    {
+        map_index.by_place[br].clear();
+        map_index.by_depth[br].clear();
+    }
+    map_index.by_tag.clear();
+
+    for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+    {
+        const map_def &mapdef = vdefs[i];
+        const bool by_depth = !_never_depth_selectable(mapdef);
+        for (int br = 0; br < NUM_BRANCHES; ++br)
+        {
+            const branch_type branch = static_cast<branch_type>(br);
+            if (mapdef.place.may_be_usable_in(branch))
+                map_index.by_place[br].push_back(i);
+            if (by_depth && mapdef.depths.may_be_usable_in(branch))
+                map_index.by_depth[br].push_back(i);
+        }
+        for (intern_id tag : mapdef.get_tag_ids())
+            map_index.by_tag[tag].push_back(i);
+    }
+
+    map_index.valid = true;
+}
+
+// The maps worth testing with accept(), or nullptr if that's all of them.
+const vault_indices *map_selector::candidates() const
+{
+    static const vault_indices none;
+
+    if (!map_index.valid)
+        _build_map_index();
+
+    switch (sel)
+    {
+    case PLACE:
+        return &map_index.by_place[place.branch];
+
+    case DEPTH:
+    case DEPTH_AND_CHANCE:
+        return &map_index.by_depth[place.branch];
+
+    case TAG:
+    {
+        // Maps must have all the tags, so the rarest one will do.
+        const vault_indices *rarest = nullptr;
+        for (const string &wanted : parse_tags(tag))
+        {
+            auto found = map_index.by_tag.find(lookup_interned(wanted));
+            if (found == map_index.by_tag.end())
+                return &none;
+            if (!rarest || found->second.size() < rarest->size())
+                rarest = &found->second;
+        }
+        return rarest;
+    }
+
+    default:
+        return nullptr;
+    }
+}
 
 static vault_indices _eligible_maps_for_selector(const map_selector &sel)
 {
@@ -974,9 +1073,18 @@ static vault_indices _eligible_maps_for_selector(const map_selector &sel)
 
     if (sel.valid())
     {
-        for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
-            if (sel.accept(vdefs[i]))
-                eligible.push_back(i);
+        if (const vault_indices *maps = sel.candidates())
+        {
+            for (unsigned i : *maps)
+                if (sel.accept(vdefs[i]))
+                    eligible.push_back(i);
+        }
+        else
+        {
+            for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+                if (sel.accept(vdefs[i]))
+                    eligible.push_back(i);
+        }
     }
 
     return eligible;
@@ -1277,14 +1385,32 @@ static bool verify_file_version(const string &file, time_t mtime)
     }
 }
 
-static bool _verify_map_index(const string &base, time_t mtime)
+static bool _verify_map_full(const string &base, time_t mtime)
 {
-    return verify_file_version(base + ".idx", mtime);
+    return verify_file_version(base + ".dsc", mtime);
 }
 
-static bool _verify_map_full(const string &base, time_t mtime)
+static bool _read_whole_file(const string &file, vector<unsigned char> &buf)
 {
-    return verify_file_version(base + ".dsc", mtime);
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    buf.clear();
+    const size_t block = 64 * 1024;
+    size_t got;
+    do
+    {
+        const size_t at = buf.size();
+        buf.resize(at + block);
+        got = fread(&buf[at], 1, block, fp);
+        buf.resize(at + got);
+    }
+    while (got == block);
+
+    const bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
 }
 
 static bool _load_map_index(const string& cache, const string &base,
@@ -1310,21 +1436,34 @@ static bool _load_map_index(const string& cache, const string &base,
         global_preludes.push_back(lc_global_prelude);
     }
 
-    FILE* fp = fopen_u((base + ".idx").c_str(), "rb");
-    if (!fp)
-        end(1, true, "Unable to read %s", (base + ".idx").c_str());
+    // The index is read into memory in one go: unmarshalling it a byte at a
+    // time through stdio is most of the cost of loading it.
+    vector<unsigned char> idx;
+    if (!_read_whole_file(base + ".idx", idx))
+        return false;
 
-    reader inf(fp, TAG_MINOR_VERSION);
-    // Re-check version, might have been modified in the meantime.
-    const auto version = get_save_version(inf);
+    reader inf(idx, TAG_MINOR_VERSION);
+    inf.set_safe_read(true);
+    save_version version;
+    int8_t word;
+    int64_t t;
+    try
+    {
+        version = get_save_version(inf);
+        word = unmarshallByte(inf);
+        t = unmarshallSigned(inf);
+    }
+    catch (short_read_exception &E)
+    {
+        return false;
+    }
     const auto major = version.major, minor = version.minor;
-    int8_t word = unmarshallByte(inf);
-    int64_t t = unmarshallSigned(inf);
     if (major != TAG_MAJOR_VERSION || minor > TAG_MINOR_VERSION
         || word != WORD_LEN || t != mtime)
     {
         return false;
     }
+    inf.set_safe_read(false);
 
 #if TAG_MAJOR_VERSION == 34
     // Throw out indices that could have CHANCE priority entirely.
@@ -1335,6 +1474,7 @@ static bool _load_map_index(const string& cache, const string &base,
     const int nmaps = unmarshallShort(inf);
     const int nexist = vdefs.size();
     vdefs.resize(nexist + nmaps, map_def());
+    _invalidate_map_index();
     for (int i = 0; i < nmaps; ++i)
     {
         map_def &vdef(vdefs[nexist + i]);
@@ -1346,7 +1486,6 @@ static bool _load_map_index(const string& cache, const string &base,
         lc_loaded_maps[vdef.name] = vdef.place_loaded_from;
         vdef.place_loaded_from.clear();
     }
-    fclose(fp);
 
     return true;
 }
@@ -1359,15 +1498,10 @@ static bool _load_map_cache(const string &filename, const string &cachename)
     file_lock deslock(descache_base + ".lk", "rb", false);
 
     time_t mtime = file_modtime(filename);
-    string file_idx = descache_base + ".idx";
-    string file_dsc = descache_base + ".dsc";
 
-    // What's the point in checking these twice (here and in load_ma_index)?
-    if (!_verify_map_index(descache_base, mtime)
-        || !_verify_map_full(descache_base, mtime))
-    {
+    // The index is checked as it is loaded.
+    if (!_verify_map_full(descache_base, mtime))
         return false;
-    }
 
     return _load_map_index(cachename, descache_base, mtime);
 }
@@ -1518,6 +1652,7 @@ void reread_maps()
 
     // BOOM!
     vdefs.clear();
+    _invalidate_map_index();
     map_files_read.clear();
     read_maps();
 }
@@ -1537,6 +1672,7 @@ void add_parsed_map(const map_def &md)
 
     map.fixup();
     vdefs.push_back(map);
+    _invalidate_map_index();
 }
 
 void run_map_global_preludes()
@@ -1565,6 +1701,8 @@ void run_map_local_preludes()
             }
         }
     }
+    // The preludes may have changed tags or depths.
+    _invalidate_map_index();
 }
 
 const map_def *map_by_index(int index)
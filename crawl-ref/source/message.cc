@@ -595,6 +595,9 @@ public:
     // write to screen (without refresh)
     void show()
     {
+        if (crawl_state.disables[DIS_DISPLAY])
+            return;
+
         // XXX: this should not be necessary as formatted_string should
         //      already do it
         textcolour(LIGHTGREY);
@@ -1909,6 +1912,10 @@ static bool _pre_more()
     if (!crawl_state.show_more_prompt || msg::_suppressed())
         return true;
 
+    // Nobody would see the messages being held back.
+    if (crawl_state.disables[DIS_DISPLAY])
+        return true;
+
     return false;
 }
 
@@ -2257,8 +2257,8 @@ static void _post_monster_move(monster* mons)
         monster_die(*mons, KILL_MISC, NON_MONSTER);
 }
 
-priority_queue<pair<monster *, int>,
-               vector<pair<monster *, int> >,
+priority_queue<monster_action,
+               vector<monster_action>,
                MonsterActionQueueCompare> monster_queue;
 
 // Inserts a monster into the monster queue (needed to ensure that any monsters
@@ -2266,7 +2266,8 @@ priority_queue<pair<monster *, int>,
 // this round)
 void queue_monster_for_action(monster* mons)
 {
-    monster_queue.emplace(mons, mons->speed_increment);
+    monster_queue.push({mons->speed_increment,
+                        (unsigned short) mons->mindex(), mons->mid});
 }
 
 static void _clear_monster_flags()
@@ -2275,8 +2276,8 @@ static void _clear_monster_flags()
     // monsters get their actions in the next round.
     // Also clear one-turn deep sleep flag.
     // XXX: MF_JUST_SLEPT only really works for player-cast hibernation.
-    for (auto &mons : menv_real)
-        mons.flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
+    for (monster_iterator mi; mi; ++mi)
+        mi->flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
 }
 
 /**
@@ -2340,11 +2341,13 @@ static void _display_just_seen()
  */
 void handle_monsters(bool with_noise)
 {
+    prune_monster_slots();
+
     for (monster_iterator mi; mi; ++mi)
     {
         _pre_monster_move(**mi);
         if (!invalid_monster(*mi) && mi->alive() && mi->has_action_energy())
-            monster_queue.emplace(*mi, mi->speed_increment);
+            queue_monster_for_action(*mi);
     }
 
     int tries = 0; // infinite loop protection, shouldn't be ever needed
@@ -2354,14 +2357,19 @@ void handle_monsters(bool with_noise)
         {
             die("infinite handle_monsters() loop, mons[0 of %d] is %s",
                 (int)monster_queue.size(),
-                monster_queue.top().first->name(DESC_PLAIN, true).c_str());
+                env.mons[monster_queue.top().index].name(DESC_PLAIN, true)
+                                                   .c_str());
         }
 
-        monster *mon = monster_queue.top().first;
-        const int oldspeed = monster_queue.top().second;
+        const monster_action next = monster_queue.top();
         monster_queue.pop();
 
-        if (invalid_monster(mon) || !mon->alive() || !mon->has_action_energy())
+        // The monster may have died since it was queued, and the slot gone
+        // to another; or this may be left over from a level we were
+        // banished from.
+        monster *mon = &env.mons[next.index];
+        const int oldspeed = next.energy;
+        if (mon->mid != next.mid || !mon->alive() || !mon->has_action_energy())
             continue;
 
         _update_monster_attitude(mon);
@@ -2378,7 +2386,7 @@ void handle_monsters(bool with_noise)
         }
 
         if (mon->has_action_energy())
-            monster_queue.emplace(mon, mon->speed_increment);
+            queue_monster_for_action(mon);
 
         // If the player got banished, discard pending monster actions.
         if (you.banished)
@@ -14,12 +14,21 @@ using std::pair;
 class monster;
 struct bolt;
 
+// A monster waiting for its action this round. The mid tells whether the
+// slot still holds the same monster once its turn comes up.
+struct monster_action
+{
+    int energy;             // speed_increment when it was queued
+    unsigned short index;
+    mid_t mid;
+};
+
 class MonsterActionQueueCompare
 {
 public:
-    bool operator() (pair<monster*, int> m1, pair<monster*, int> m2)
+    bool operator() (const monster_action &m1, const monster_action &m2)
     {
-        return m1.second < m2.second;
+        return m1.energy < m2.energy;
     }
 };
 
@@ -211,6 +211,18 @@ bool try_pathfind(monster* mon)
          mon->name(DESC_PLAIN).c_str(), mon->pos().x, mon->pos().y,
          targpos.x, targpos.y, range);
 #endif
+    // Hostile monsters hunting the player can usually read their path off
+    // a search they share with everything else that moves the same way.
+    vector<coord_def> waypoints;
+    if (foe->is_player() && shared_path_to_player(mon, range, waypoints)
+        && !waypoints.empty())
+    {
+        mon->travel_path = waypoints;
+        mon->target = mon->travel_path[0];
+        mon->travel_target = MTRAV_FOE;
+        return true;
+    }
+
     monster_pathfind mp;
     mp.set_range(range);
 
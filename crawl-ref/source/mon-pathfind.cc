@@ -8,6 +8,7 @@
 #include "misc.h"
 #include "mon-movetarget.h"
 #include "mon-place.h"
+#include "mon-util.h"
 #include "religion.h"
 #include "state.h"
 #include "terrain.h"
@@ -19,16 +20,24 @@
 // The pathfinding is an implementation of the A* algorithm. Beginning at the
 // monster position we check all neighbours of a given grid, estimate the
 // distance needed for any shortest path including this grid and push the
-// result into a hash. We can then easily access all points with the shortest
-// distance estimates and then check _their_ neighbours and so on.
+// result into a bucket queue. We can then easily access all points with the
+// shortest distance estimates and then check _their_ neighbours and so on.
 // The algorithm terminates once we reach the destination since - because
-// of the sorting of grids by shortest distance in the hash - there can be no
+// of the sorting of grids by shortest distance in the queue - there can be no
 // path between start and target that is shorter than the current one. There
 // could be other paths that have the same length but that has no real impact.
-// If the hash has been cleared and the start grid has not been encountered,
+// If the queue has been emptied and the start grid has not been encountered,
 // then there's no path that matches the requirements fed into monster_pathfind.
 // (These requirements are usually preference of habitat of a specific monster
 // or a limit of the distance between start and any grid on the path.)
+//
+// Monsters hunting the player may pathfind several times a turn, so setting
+// up a search must stay cheap: per-grid state is stamped with the search
+// generation instead of being cleared, and only the queue buckets a search
+// actually reaches get initialised.
+
+// queue_prev value for grids that aren't currently in the queue.
+static const int NOT_QUEUED = -2;
 
 int mons_tracking_range(const monster* mon)
 {
@@ -64,7 +73,7 @@ int mons_tracking_range(const monster* mon)
 monster_pathfind::monster_pathfind()
     : mons(nullptr), start(), target(), pos(), allow_diagonals(true),
       traverse_unmapped(false), range(0), min_length(0), max_length(0),
-      dist(), prev(), hash(), traversable_cache()
+      generation(0), stamp(), bucket_limit(0)
 {
 }
 
@@ -135,21 +144,13 @@ bool monster_pathfind::start_pathfind(bool msg)
     //       surrounded by shallow water or floor, or if a foe is hiding in
     //       a wall.
 
-    max_length = min_length = grid_distance(pos, target);
-    for (int i = 0; i < GXM; i++)
-        for (int j = 0; j < GYM; j++)
-        {
-            dist[i][j] = INFINITE_DISTANCE;
-            traversable_cache[i][j] = MB_MAYBE;
-        }
-
-    dist[pos.x][pos.y] = 0;
+    begin_search();
 
     bool success = false;
     do
     {
         // Calculate the distance to all neighbours of the current position,
-        // and add them to the hash, if they haven't already been looked at.
+        // and add them to the queue, if they haven't already been looked at.
         success = calc_path_to_neighbours();
         if (success)
             return true;
@@ -170,6 +171,23 @@ bool monster_pathfind::start_pathfind(bool msg)
     while (true);
 }
 
+// Start a new search from pos, forgetting everything a previous search on
+// this instance found.
+void monster_pathfind::begin_search()
+{
+    max_length = min_length = estimated_cost(pos);
+
+    if (++generation == 0)
+    {
+        memset(stamp, 0, sizeof(stamp));
+        generation = 1;
+    }
+    bucket_limit = 0;
+
+    touch_pos(pos);
+    dist[pos.x][pos.y] = 0;
+}
+
 // Returns true as soon as we encounter the target.
 bool monster_pathfind::calc_path_to_neighbours()
 {
@@ -205,6 +223,8 @@ bool monster_pathfind::calc_path_to_neighbours()
         if (!in_bounds(npos))
             continue;
 
+        touch_pos(npos);
+
         if (!traversable_memoized(npos) && npos != target)
             continue;
 
@@ -238,7 +258,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             if (old_dist == INFINITE_DISTANCE)
             {
 #ifdef DEBUG_PATHFIND
-                mprf("Adding (%d,%d) to hash (total dist = %d)",
+                mprf("Adding (%d,%d) to queue (total dist = %d)",
                      npos.x, npos.y, total);
 #endif
                 add_new_pos(npos, total);
@@ -280,22 +300,23 @@ bool monster_pathfind::calc_path_to_neighbours()
 }
 
 // Starting at known min_length (minimum total estimated path distance), check
-// the hash for existing vectors, then pick the last entry of the first vector
-// that matches. Update min_length, if necessary.
+// the queue for non-empty buckets, then pick the newest entry of the first
+// bucket that matches. Update min_length, if necessary.
 bool monster_pathfind::get_best_position()
 {
-    for (int i = min_length; i <= max_length; i++)
+    const int last = min(max_length, bucket_limit - 1);
+    for (int i = min_length; i <= last; i++)
     {
-        if (!hash[i].empty())
+        const int idx = bucket_head[i];
+        if (idx != -1)
         {
             if (i > min_length)
                 min_length = i;
 
-            vector<coord_def> &vec = hash[i];
-            // Pick the last position pushed into the vector as it's most
+            // Pick the last position pushed into the bucket as it's most
             // likely to be close to the target.
-            pos = vec[vec.size()-1];
-            vec.pop_back();
+            unlink_pos(idx, i);
+            pos = coord_def(idx / GYM, idx % GYM);
 
 #ifdef DEBUG_PATHFIND
             mprf("Returning (%d, %d) as best pos with total dist %d.",
@@ -357,8 +378,12 @@ vector<coord_def> monster_pathfind::backtrack()
 // avoid plants and other monsters in the way.
 vector<coord_def> monster_pathfind::calc_waypoints()
 {
-    vector<coord_def> path = backtrack();
+    return path_to_waypoints(backtrack());
+}
 
+vector<coord_def> monster_pathfind::path_to_waypoints(
+    const vector<coord_def> &path)
+{
     // If no path found, nothing to be done.
     if (path.empty())
         return path;
@@ -500,26 +525,297 @@ int monster_pathfind::estimated_cost(coord_def p)
     return grid_distance(p, target);
 }
 
+// Reset a grid's search state if it was last touched by an earlier search.
+void monster_pathfind::touch_pos(const coord_def& p)
+{
+    if (stamp[p.x][p.y] == generation)
+        return;
+
+    stamp[p.x][p.y] = generation;
+    dist[p.x][p.y] = INFINITE_DISTANCE;
+    traversable_cache[p.x][p.y] = MB_MAYBE;
+    queue_prev[p.x * GYM + p.y] = NOT_QUEUED;
+}
+
 void monster_pathfind::add_new_pos(coord_def npos, int total)
 {
-    hash[total].push_back(npos);
+    ASSERT_RANGE(total, 0, GXM * GYM);
+    while (bucket_limit <= total)
+        bucket_head[bucket_limit++] = -1;
+
+    const int idx = npos.x * GYM + npos.y;
+    const int head = bucket_head[total];
+    queue_next[idx] = head;
+    queue_prev[idx] = -1;
+    if (head != -1)
+        queue_prev[head] = idx;
+    bucket_head[total] = idx;
+}
+
+// Remove a grid from the bucket it was queued in, if it is still queued.
+void monster_pathfind::unlink_pos(int idx, int total)
+{
+    const int before = queue_prev[idx];
+    const int after = queue_next[idx];
+    if (before == NOT_QUEUED)
+        return;
+
+    if (before == -1)
+        bucket_head[total] = after;
+    else
+        queue_next[before] = after;
+    if (after != -1)
+        queue_prev[after] = before;
+    queue_prev[idx] = NOT_QUEUED;
 }
 
 void monster_pathfind::update_pos(coord_def npos, int total)
 {
-    // Find hash position of old distance and delete it,
-    // then call_add_new_pos.
-    int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
+    // Take the grid out of the bucket for its old distance,
+    // then call add_new_pos.
+    const int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
+    unlink_pos(npos.x * GYM + npos.y, old_total);
+
+    add_new_pos(npos, total);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Shared flow fields
+//
+// Hostile monsters hunting the player all search towards the same grid, which
+// on crowded levels (Ziggurats, Pandemonium, the Abyss) means a lot of
+// repeated work. Instead, we search outwards from the player once per
+// movement class and let every monster of that class read its path off the
+// result. There's no single goal, so the search is Dijkstra (A* without an
+// estimate), and it only settles grids as far out as the asking monsters need.
+//
+// A field lasts until the end of the turn, the player moving, or any terrain
+// changing. Paths read from it are still checked against the monster asking,
+// and anything a field can't answer is left to a monster_pathfind search.
+
+// Fields kept around at once; further movement classes in a turn fall back to
+// searching on their own.
+static const unsigned int MAX_FLOW_FIELDS = 8;
+
+// Everything about a monster that monster_pathfind looks at to decide where
+// it may go and what each step costs, short of per-monster trap safety.
+struct monster_flow_class
+{
+    habitat_type class_primary;
+    habitat_type class_secondary;
+    habitat_type primary;
+    habitat_type real_habitat;
+    bool class_flies;
+    bool airborne;
+    bool passes_doors;
+    bool brainless;
+
+    bool operator==(const monster_flow_class &other) const
+    {
+        return class_primary == other.class_primary
+               && class_secondary == other.class_secondary
+               && primary == other.primary
+               && real_habitat == other.real_habitat
+               && class_flies == other.class_flies
+               && airborne == other.airborne
+               && passes_doors == other.passes_doors
+               && brainless == other.brainless;
+    }
+};
+
+static monster_flow_class _flow_class(const monster* mon)
+{
+    const monster_type mt = fixup_zombie_type(mon->type,
+                                              mons_base_type(*mon));
+    const monster_type base = mons_base_type(*mon);
+
+    monster_flow_class fc;
+    fc.class_primary = mons_class_primary_habitat(mt);
+    fc.class_secondary = mons_class_secondary_habitat(mt);
+    fc.primary = mons_primary_habitat(*mon);
+    fc.real_habitat = mons_habitat(*mon, true);
+    fc.class_flies = mons_class_flag(mt, M_FLIES);
+    fc.airborne = mon->airborne();
+    // Hostile monsters only; allies never open doors.
+    fc.passes_doors = mon->can_pass_through_feat(DNGN_FLOOR)
+                      && (mons_itemuse(*mon) >= MONUSE_OPEN_DOORS
+                          || mons_eats_items(*mon)
+                          || mons_class_flag(base, M_EAT_DOORS)
+                          || mons_class_flag(base, M_CRASH_DOORS));
+    fc.brainless = mons_intel(*mon) == I_BRAINLESS;
+    return fc;
+}
+
+static bool _can_share_flow_field(const monster* mon)
+{
+    if (mon->attitude != ATT_HOSTILE)
+        return false;
+
+    // These get special treatment in monster_pathfind::traversable() or in
+    // monster_habitable_grid().
+    const monster_type mt = fixup_zombie_type(mon->type,
+                                              mons_base_type(*mon));
+    switch (mt)
+    {
+    case MONS_THORN_HUNTER:
+    case MONS_WANDERING_MUSHROOM:
+    case MONS_KRAKEN:
+    case MONS_ELDRITCH_TENTACLE:
+    case MONS_ELDRITCH_TENTACLE_SEGMENT:
+        return false;
+    default:
+        return true;
+    }
+}
+
+class monster_flow_field : public monster_pathfind
+{
+public:
+    monster_flow_field() : fclass(), turn(-1) { }
+
+    bool current() const
+    {
+        return turn == you.num_turns && start == you.pos();
+    }
+    bool serves(const monster_flow_class &fc) const
+    {
+        return current() && fclass == fc;
+    }
+    void invalidate()
+    {
+        turn = -1;
+    }
+
+    void restart(const monster* mon, const monster_flow_class &fc);
+    bool waypoints_for(const monster* mon, int max_range,
+                       vector<coord_def> &waypoints);
+
+protected:
+    int estimated_cost(coord_def npos) override;
+
+private:
+    bool settle(const coord_def &p);
+
+    monster_flow_class fclass;
+    int turn;
+};
+
+void monster_flow_field::restart(const monster* mon,
+                                 const monster_flow_class &fc)
+{
+    mons = mon;
+    fclass = fc;
+    turn = you.num_turns;
+
+    start = pos = you.pos();
+    // Never reached, so that every grid gets settled in turn.
+    target = coord_def(-1, -1);
+    allow_diagonals = true;
+    traverse_unmapped = false;
+    traverse_in_sight = false;
+    range = 0;
+
+    begin_search();
+    calc_path_to_neighbours();
+}
+
+int monster_flow_field::estimated_cost(coord_def /*npos*/)
+{
+    return 0;
+}
+
+// Keep settling grids in order of distance from the player until p is
+// settled. Returns false if p can't be reached at all.
+bool monster_flow_field::settle(const coord_def &p)
+{
+    touch_pos(p);
+    while (dist[p.x][p.y] == INFINITE_DISTANCE
+           || queue_prev[p.x * GYM + p.y] != NOT_QUEUED)
+    {
+        if (!get_best_position())
+            return false;
+        calc_path_to_neighbours();
+    }
+    return true;
+}
+
+bool monster_flow_field::waypoints_for(const monster* mon, int max_range,
+                                       vector<coord_def> &waypoints)
+{
+    // Any monster of the right class will do for settling further grids, and
+    // the one asking is certainly still around.
+    mons = mon;
+
+    const coord_def from = mon->pos();
+    if (!settle(from))
+        return false;
+
+    // The same bounds monster_pathfind::set_range() would have imposed.
+    if (dist[from.x][from.y] > max_range * 2)
+        return false;
+
+    vector<coord_def> path;
+    for (coord_def p = from; ; p = next_pos(p))
+    {
+        path.push_back(p);
+        if (p == start)
+            break;
+        if (grid_distance(p, start) > max_range
+            || p != from && !traversable(p))
+        {
+            return false;
+        }
+    }
+
+    waypoints = path_to_waypoints(path);
+    return true;
+}
+
+static vector<unique_ptr<monster_flow_field>> flow_fields;
+
+// Look up a path to the player for a hostile monster in this turn's flow
+// field for its movement class, computing the field if needed. Returns false
+// if the monster should search on its own instead.
+bool shared_path_to_player(const monster* mon, int range,
+                           vector<coord_def> &waypoints)
+{
+    if (!_can_share_flow_field(mon))
+        return false;
 
-    vector<coord_def> &vec = hash[old_total];
-    for (unsigned int i = 0; i < vec.size(); i++)
+    const monster_flow_class fc = _flow_class(mon);
+    monster_flow_field* field = nullptr;
+    monster_flow_field* spare = nullptr;
+    for (auto &ff : flow_fields)
     {
-        if (vec[i] == npos)
+        if (ff->serves(fc))
         {
-            vec.erase(vec.begin() + i);
+            field = ff.get();
             break;
         }
+        if (!spare && !ff->current())
+            spare = ff.get();
     }
 
-    add_new_pos(npos, total);
+    if (!field)
+    {
+        if (spare)
+            field = spare;
+        else if (flow_fields.size() < MAX_FLOW_FIELDS)
+        {
+            flow_fields.emplace_back(new monster_flow_field);
+            field = flow_fields.back().get();
+        }
+        else
+            return false;
+
+        field->restart(mon, fc);
+    }
+
+    return field->waypoints_for(mon, range, waypoints);
+}
+
+void invalidate_flow_fields()
+{
+    for (auto &ff : flow_fields)
+        ff->invalidate();
 }
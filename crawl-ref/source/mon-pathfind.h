@@ -12,6 +12,9 @@ using std::vector;
 class monster;
 
 int mons_tracking_range(const monster* mon);
+bool shared_path_to_player(const monster* mon, int range,
+                           vector<coord_def> &waypoints);
+void invalidate_flow_fields();
 
 class monster_pathfind
 {
@@ -33,16 +36,20 @@ public:
 
 protected:
     // protected methods
+    void begin_search();
     bool calc_path_to_neighbours();
     bool traversable(const coord_def& p);
     bool traversable_memoized(const coord_def& p);
     int  travel_cost(coord_def npos);
     bool mons_traversable(const coord_def& p);
     int  mons_travel_cost(coord_def npos);
-    int  estimated_cost(coord_def npos);
+    virtual int estimated_cost(coord_def npos);
     void add_new_pos(coord_def pos, int total);
     void update_pos(coord_def pos, int total);
     bool get_best_position();
+    void touch_pos(const coord_def& p);
+    void unlink_pos(int idx, int total);
+    vector<coord_def> path_to_waypoints(const vector<coord_def> &path);
 
     // The monster trying to find a path.
     const monster* mons;
@@ -69,12 +76,25 @@ protected:
     int min_length;
     int max_length;
 
+    // Every search gets a new generation. dist and traversable_cache are
+    // only meaningful for grids whose stamp matches the current generation,
+    // so starting a search doesn't need to clear them.
+    uint32_t generation;
+    uint32_t stamp[GXM][GYM];
+
     // The array of distances from start to any already tried point.
     int dist[GXM][GYM];
     // An array to store where we came from on a given shortest path.
-    int prev[GXM][GYM];
-
-    FixedVector<vector<coord_def>, GXM * GYM> hash;
+    int8_t prev[GXM][GYM];
 
     maybe_bool traversable_cache[GXM][GYM];
+
+    // Grids waiting to be looked at, bucketed by estimated total path
+    // length. Each bucket is a doubly linked list threaded through
+    // queue_next/queue_prev (indexed by x * GYM + y), newest entry first.
+    // Only buckets below bucket_limit have been initialised this search.
+    int bucket_head[GXM * GYM];
+    int bucket_limit;
+    int queue_next[GXM * GYM];
+    int queue_prev[GXM * GYM];
 };
@@ -857,6 +857,7 @@ monster* get_free_monster()
         if (mons.type == MONS_NO_MONSTER)
         {
             mons.reset();
+            note_monster_slot(mons);
             return &mons;
         }
 
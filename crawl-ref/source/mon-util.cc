@@ -5151,6 +5151,33 @@ void reset_all_monsters()
     }
 
     env.mid_cache.clear();
+    env.mons_slots.clear();
+}
+
+// Called whenever a free slot is handed out, before it holds a monster.
+void note_monster_slot(const monster& mon)
+{
+    const unsigned short i = mon.mindex();
+    auto it = lower_bound(env.mons_slots.begin(), env.mons_slots.end(), i);
+    if (it == env.mons_slots.end() || *it != i)
+        env.mons_slots.insert(it, i);
+}
+
+// Forget the slots that have been emptied. Only safe between monster
+// placements, since a slot just handed out is still empty.
+void prune_monster_slots()
+{
+    erase_if(env.mons_slots, [](unsigned short i)
+             {
+                 return env.mons[i].type == MONS_NO_MONSTER;
+             });
+}
+
+// The first slot after i that might hold a live monster, or MAX_MONSTERS.
+int next_monster_slot(int i)
+{
+    auto it = upper_bound(env.mons_slots.begin(), env.mons_slots.end(), i);
+    return it == env.mons_slots.end() ? (int) MAX_MONSTERS : *it;
 }
 
 bool mons_is_recallable(const actor* caller, const monster& targ)
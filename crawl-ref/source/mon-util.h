@@ -529,6 +529,9 @@ bool mons_is_player_shadow(const monster& mon);
 bool mons_has_attacks(const monster& mon);
 
 void reset_all_monsters();
+void note_monster_slot(const monster& mon);
+void prune_monster_slots();
+int next_monster_slot(int i);
 void debug_mondata();
 void debug_monspells();
 
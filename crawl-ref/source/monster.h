@@ -54,13 +54,19 @@ public:
     void reset();
 
 public:
-    // Possibly some of these should be moved into the hash table
-    string mname;
-
+    // What the turn loop checks for every monster on the level: kept
+    // together, close to actor's type and position, so that skimming the
+    // monsters doesn't pull in most of each (rather large) object.
+    monster_flags_t flags;             // bitfield of boolean flags
     int hit_points;
     int max_hit_points;
     int speed;
     int speed_increment;
+    mon_attitude_type attitude;
+    beh_type behaviour;
+
+    // Possibly some of these should be moved into the hash table
+    string mname;
 
     coord_def target;
     coord_def firing_pos;
@@ -69,13 +75,10 @@ public:
     vector<coord_def> travel_path;
     FixedVector<short, NUM_MONSTER_SLOTS> inv;
     monster_spells spells;
-    mon_attitude_type attitude;
-    beh_type behaviour;
     unsigned short foe;
     int8_t ench_countdown;
     mon_enchant_list enchantments;
     FixedBitVector<NUM_ENCHANTMENTS> ench_cache;
-    monster_flags_t flags;             // bitfield of boolean flags
     xp_tracking_type xp_tracking;
 
     unsigned int experience;
@@ -141,5 +141,7 @@ private:
 private:
     FixedArray<noise_cell, GXM, GYM> cells;
     vector<noise_t> noises;
+    // Kept between propagations only to reuse the allocations.
+    vector<coord_def> noise_perimeter[2];
     int affected_actor_count;
 };
@@ -536,7 +536,7 @@ void update_message_status()
 
 void update_turn_count()
 {
-    if (crawl_state.game_is_arena())
+    if (crawl_state.game_is_arena() || crawl_state.disables[DIS_DISPLAY])
         return;
 
     // Don't update turn counter when running/resting/traveling to
@@ -1299,6 +1299,8 @@ static void _redraw_title()
 
 void print_stats()
 {
+    if (crawl_state.disables[DIS_DISPLAY])
+        return;
 #ifndef USE_TILE_LOCAL
     if (crawl_state.smallterm)
         return;
@@ -1489,6 +1491,13 @@ void redraw_screen(bool show_updates)
     }
 #endif
 
+    // Nothing gets drawn, but the map knowledge still has to be updated.
+    if (crawl_state.disables[DIS_DISPLAY])
+    {
+        viewwindow(show_updates);
+        return;
+    }
+
     draw_border();
 
     you.redraw_stats.init(true);
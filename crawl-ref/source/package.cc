@@ -16,6 +16,21 @@ Notes:
 * Readers always get the last complete (but not necessarily committed) write
   (ie, READ_UNCOMMITTED) at the time they started; it is safe to continue
   reading even if the chunk has been changed since.
+* With USE_MMAP, blocks are read (and inflated) straight from a shared
+  read-only mapping of the file, which relies on the mapping seeing our own
+  later write()s, as it does with any unified buffer cache. Blocks past the
+  end of the mapping are read the old way until the next commit() remaps.
+* The codec (see package_codec) applies to the whole package, directory
+  included, and is stored in the file header. Packages written before codecs
+  existed have a zero there, which is zlib. The zlib level isn't recorded
+  anywhere, as inflate() doesn't need to know it.
+* After write_in_background(), chunk writes, deletions and commits are queued
+  for a writer thread, in order, and the file only catches up with them later.
+  A crash loses whatever is still queued, as if the game had died before
+  making those calls, so the save still returns to some earlier commit().
+  Until then, the game sees its queued chunks as if they had been written.
+  Anything that needs the file itself to be up to date must flush() first;
+  the destructor does.
 */
 
 #include "AppHdr.h"
@@ -32,12 +47,22 @@ Notes:
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef USE_ASYNC_SAVE
+#include <deque>
+#include <exception>
+#endif
 
 #include "end.h"
 #include "endianness.h"
 #include "errors.h"
 #include "syscalls.h"
 #include "libutil.h" // map_find
+#ifdef USE_ASYNC_SAVE
+#include "threads.h"
+#endif
 
 // debugging defines
 #undef  FSCK_VERBOSE
@@ -62,11 +87,18 @@ static plen_t htole(plen_t x)
 #define PACKAGE_VERSION 1
 #define PACKAGE_MAGIC   0x53534344 /* "DCSS" */
 
+#ifdef USE_ZLIB
+#define DEFAULT_LEVEL Z_DEFAULT_COMPRESSION
+#else
+#define DEFAULT_LEVEL 0
+#endif
+
 struct file_header
 {
     uint32_t magic;
     uint8_t version;
-    char padding[3];
+    uint8_t codec;
+    char padding[2];
     plen_t start;
 };
 
@@ -81,11 +113,63 @@ typedef pair<plen_t, plen_t> bm_p;
 typedef map<plen_t, bm_p> bm_t;
 typedef map<plen_t, plen_t> fb_t;
 
+#ifdef USE_ASYNC_SAVE
+// A chunk to write (or delete, if there's no data), or a commit.
+struct package::writer_job
+{
+    string name;
+    shared_ptr<const vector<char>> data;
+    bool commit;
+    unsigned int seq;
+};
+
+struct package::writer_thread
+{
+    mutex_t lock;  // guards the whole package
+    cond_t wake;   // there are jobs, or it's time to stop
+    cond_t idle;   // a job has been finished
+    thread_t thread;
+    deque<writer_job> jobs;
+    bool busy;
+    bool stop;
+    unsigned int last_seq;
+    exception_ptr error;
+};
+
+// Holds the package's lock while in scope, if it has a writer thread.
+class package_lock
+{
+public:
+    package_lock(const package *pkg) : async(pkg->async)
+    {
+        if (async)
+            mutex_lock(async->lock);
+    }
+    ~package_lock()
+    {
+        if (async)
+            mutex_unlock(async->lock);
+    }
+private:
+    package::writer_thread *async;
+};
+#else
+class package_lock
+{
+public:
+    package_lock(const package *) {}
+};
+#endif
+
 package::package(const char* file, bool writeable, bool empty)
-  : n_users(0), dirty(false), aborted(false)
+  : n_users(0), dirty(false), aborted(false), codec(PCODEC_DEFAULT),
+    level(DEFAULT_LEVEL), async(nullptr)
 #ifdef DO_FSYNC
     , tmp(false)
 #endif
+#ifdef USE_MMAP
+    , mapping(nullptr), mapping_len(0)
+#endif
 {
     dprintf("package: initializing file=\"%s\" rw=%d\n", file, writeable);
     ASSERT(writeable || !empty);
@@ -125,6 +209,9 @@ package::package(const char* file, bool writeable, bool empty)
         }
         catch (exception &e)
         {
+#ifdef USE_MMAP
+            unmap_file();
+#endif
             close(fd);
             throw;
         }
@@ -132,10 +219,14 @@ package::package(const char* file, bool writeable, bool empty)
 }
 
 package::package()
-  : rw(true), n_users(0), dirty(false), aborted(false)
+  : rw(true), n_users(0), dirty(false), aborted(false),
+    codec(PCODEC_DEFAULT), level(DEFAULT_LEVEL), async(nullptr)
 #ifdef DO_FSYNC
     , tmp(true)
 #endif
+#ifdef USE_MMAP
+    , mapping(nullptr), mapping_len(0)
+#endif
 {
     dprintf("package: initializing tmp file\n");
     filename = "[tmp]";
@@ -163,8 +254,8 @@ void package::load()
     ssize_t res = ::read(fd, &head, sizeof(file_header));
     if (res < 0)
         sysfail("error reading the save file (%s)", filename.c_str());
-    if (!res || !(head.magic || head.version || head.padding[0]
-                  || head.padding[1] || head.padding[2] || head.start))
+    if (!res || !(head.magic || head.version || head.codec
+                  || head.padding[0] || head.padding[1] || head.start))
     {
         corrupted("The save file (%s) is empty!", filename.c_str());
     }
@@ -180,6 +271,24 @@ void package::load()
     if (len == -1)
         sysfail("save file (%s) is not seekable", filename.c_str());
     file_len = len;
+
+    if (head.codec >= NUM_PCODECS)
+    {
+        corrupted("save file (%s) uses an unknown compression codec %u",
+                  filename.c_str(), head.codec);
+    }
+    codec = static_cast<package_codec>(head.codec);
+#ifndef USE_ZLIB
+    if (codec == PCODEC_ZLIB)
+    {
+        fail("save file (%s) is compressed, but zlib support is disabled",
+             filename.c_str());
+    }
+#endif
+
+#ifdef USE_MMAP
+    map_file();
+#endif
     read_directory(htole(head.start), head.version);
 
     if (rw)
@@ -214,6 +323,11 @@ package::~package()
         // catching missing manual deletes. The C++ exit handler is the
         // only place that can be legitimately call things in wrong order.
 
+#ifdef USE_ASYNC_SAVE
+    if (async)
+        stop_writer(false);
+#endif
+
     if (rw && !aborted)
     {
         commit();
@@ -221,6 +335,9 @@ package::~package()
             sysfail("failed to update save file");
     }
 
+#ifdef USE_MMAP
+    unmap_file();
+#endif
     // all errors here should be cached write errors
     if (fd != -1)
         if (close(fd) && !aborted)
@@ -234,6 +351,25 @@ package::~package()
 void package::commit()
 {
     ASSERT(rw);
+#ifdef USE_ASYNC_SAVE
+    if (async)
+    {
+        {
+            package_lock lock(this);
+            if (async->error)
+                rethrow_exception(async->error);
+        }
+        writer_job job;
+        job.commit = true;
+        queue_job(job);
+        return;
+    }
+#endif
+    commit_now();
+}
+
+void package::commit_now()
+{
     if (!dirty)
         return;
     ASSERT(!aborted);
@@ -245,30 +381,82 @@ void package::commit()
     file_header head;
     head.magic = htole(PACKAGE_MAGIC);
     head.version = PACKAGE_VERSION;
+    head.codec = codec;
     memset(&head.padding, 0, sizeof(head.padding));
     head.start = htole(write_directory());
-#ifdef DO_FSYNC
     // We need a barrier before updating the link to point at the new directory.
-    if (!tmp && fdatasync(fd))
-        sysfail("flush error while saving");
-#endif
+    sync_data();
     seek(0);
     if (write(fd, &head, sizeof(head)) != sizeof(head))
         sysfail("write error while saving");
-#ifdef DO_FSYNC
-    if (!tmp && fdatasync(fd))
-        sysfail("flush error while saving");
-#endif
+    sync_data();
 
     new_chunks.clear();
     collect_blocks();
     dirty = false;
 
+#ifdef USE_MMAP
+    // Live readers may be inflating straight from the old mapping.
+    if (reader_count.empty())
+        map_file();
+#endif
+
 #ifdef COSTLY_ASSERTS
     fsck();
 #endif
 }
 
+// Wait for everything written so far to reach the disk. The writer thread
+// lets go of the package meanwhile, so that the game can keep reading.
+void package::sync_data()
+{
+#ifdef DO_FSYNC
+    if (tmp)
+        return;
+# ifdef USE_ASYNC_SAVE
+    if (async)
+        mutex_unlock(async->lock);
+# endif
+    const int res = fdatasync(fd);
+    const int err = errno;
+# ifdef USE_ASYNC_SAVE
+    if (async)
+        mutex_lock(async->lock);
+# endif
+    errno = err;
+    if (res)
+        sysfail("flush error while saving");
+#endif
+}
+
+void package::set_codec(package_codec new_codec)
+{
+    ASSERT(rw);
+    ASSERT_RANGE(new_codec, 0, NUM_PCODECS);
+#ifndef USE_ZLIB
+    ASSERT(new_codec != PCODEC_ZLIB);
+#endif
+    // Existing chunks would become unreadable.
+    ASSERT(!n_users);
+    ASSERT(list_chunks().empty());
+
+    if (new_codec == codec)
+        return;
+    codec = new_codec;
+    // The directory, and the codec in the header, need to be rewritten.
+    dirty = true;
+}
+
+void package::set_compression_level(int new_level)
+{
+#ifdef USE_ZLIB
+    ASSERT(new_level == Z_DEFAULT_COMPRESSION
+           || new_level >= Z_NO_COMPRESSION && new_level <= Z_BEST_COMPRESSION);
+#endif
+    package_lock lock(this);
+    level = new_level;
+}
+
 void package::seek(plen_t to)
 {
     ASSERT(!aborted);
@@ -279,6 +467,68 @@ void package::seek(plen_t to)
         sysfail("failed to seek inside the save file");
 }
 
+// A pointer to len bytes of the file at at, if they're all mapped.
+const char *package::mapped(plen_t at, plen_t len) const
+{
+#ifdef USE_MMAP
+    if (mapping && at <= mapping_len && len <= mapping_len - at)
+        return mapping + at;
+#else
+    UNUSED(at, len);
+#endif
+    return nullptr;
+}
+
+void package::read_at(plen_t at, void *data, plen_t len)
+{
+    if (const char *m = mapped(at, len))
+    {
+        memcpy(data, m, len);
+        return;
+    }
+
+    seek(at);
+    ssize_t res = ::read(fd, data, len);
+    if (res < 0)
+        sysfail("error reading the save file");
+    if ((plen_t)res != len)
+        corrupted("save file corrupted -- block past eof");
+}
+
+#ifdef USE_MMAP
+void package::map_file()
+{
+    unmap_file();
+
+    // Everything below file_len has been written, but the file may be
+    // longer than that; it is only truncated when we close it.
+    struct stat st;
+    if (fstat(fd, &st) || !file_len)
+        return;
+    const plen_t len = min<off_t>(file_len, st.st_size);
+    if (!len)
+        return;
+
+    // If this fails, we simply keep reading with read().
+    void *m = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+        return;
+
+    mapping = (const char*)m;
+    mapping_len = len;
+}
+
+void package::unmap_file()
+{
+    if (!mapping)
+        return;
+
+    munmap((void*)mapping, mapping_len);
+    mapping = nullptr;
+    mapping_len = 0;
+}
+#endif
+
 chunk_writer* package::writer(const string &name)
 {
     return new chunk_writer(this, name);
@@ -286,6 +536,9 @@ chunk_writer* package::writer(const string &name)
 
 chunk_reader* package::reader(const string &name)
 {
+    package_lock lock(this);
+    if (const pending_chunk *pc = map_find(pending, name))
+        return pc->data ? new chunk_reader(this, name) : 0;
     if (plen_t *ch = map_find(directory, name))
         return new chunk_reader(this, *ch);
     return 0;
@@ -383,6 +636,21 @@ void package::free_chunk(const string &name)
 }
 
 void package::delete_chunk(const string &name)
+{
+#ifdef USE_ASYNC_SAVE
+    if (async)
+    {
+        writer_job job;
+        job.name = name;
+        job.commit = false;
+        queue_job(job);
+        return;
+    }
+#endif
+    remove_chunk(name);
+}
+
+void package::remove_chunk(const string &name)
 {
     free_chunk(name);
     directory.erase(name);
@@ -390,7 +658,7 @@ void package::delete_chunk(const string &name)
 
 plen_t package::write_directory()
 {
-    delete_chunk("");
+    remove_chunk("");
 
     stringstream dir;
     for (const auto &entry : directory)
@@ -405,7 +673,7 @@ plen_t package::write_directory()
     ASSERT(dir.str().size());
     dprintf("writing directory (%u bytes)\n", (unsigned int)dir.str().size());
     {
-        chunk_writer dch(this, "");
+        chunk_writer dch(this, "", false, true);
         dch.write(&dir.str()[0], dir.str().size());
     }
 
@@ -564,15 +832,24 @@ void package::read_directory(plen_t start, uint8_t version)
 
 bool package::has_chunk(const string &name)
 {
-    return !name.empty() && directory.count(name);
+    if (name.empty())
+        return false;
+    package_lock lock(this);
+    if (const pending_chunk *pc = map_find(pending, name))
+        return !!pc->data;
+    return directory.count(name);
 }
 
 vector<string> package::list_chunks()
 {
+    package_lock lock(this);
     vector<string> list;
-    list.reserve(directory.size());
+    list.reserve(directory.size() + pending.size());
     for (const auto &entry : directory)
-        if (!entry.first.empty())
+        if (!entry.first.empty() && !pending.count(entry.first))
+            list.push_back(entry.first);
+    for (const auto &entry : pending)
+        if (entry.second.data)
             list.push_back(entry.first);
 
     return list;
@@ -583,12 +860,7 @@ void package::trace_chunk(plen_t start)
     while (start)
     {
         block_header bl;
-        seek(start);
-        ssize_t res = ::read(fd, &bl, sizeof(block_header));
-        if (res < 0)
-            sysfail("error reading the save file");
-        if (res != sizeof(block_header))
-            corrupted("save file corrupted -- block past eof");
+        read_at(start, &bl, sizeof(block_header));
 
         plen_t len  = htole(bl.len);
         plen_t next = htole(bl.next);
@@ -619,20 +891,193 @@ void package::abort()
     // Disable any further operations, allow a shutdown. All errors past
     // this point are ignored (assuming we already failed). All writes since
     // the last commit() are lost.
+#ifdef USE_ASYNC_SAVE
+    if (async)
+        stop_writer(true);
+#endif
     aborted = true;
 }
 
 void package::unlink()
 {
     abort();
+#ifdef USE_MMAP
+    unmap_file();
+#endif
     close(fd);
     fd = -1;
     ::unlink_u(filename.c_str());
 }
 
+void package::write_in_background()
+{
+#ifdef USE_ASYNC_SAVE
+    ASSERT(rw);
+    // Writers that are already open would bypass the thread.
+    ASSERT(!n_users);
+    if (async || aborted)
+        return;
+
+    async = new writer_thread;
+    async->busy = false;
+    async->stop = false;
+    async->last_seq = 0;
+    mutex_init(async->lock);
+    cond_init(async->wake);
+    cond_init(async->idle);
+    if (thread_create_joinable(&async->thread, writer_main, this))
+    {
+        // Just keep doing everything ourselves.
+        mutex_destroy(async->lock);
+        cond_destroy(async->wake);
+        cond_destroy(async->idle);
+        delete async;
+        async = nullptr;
+    }
+#endif
+}
+
+void package::flush()
+{
+#ifdef USE_ASYNC_SAVE
+    if (!async)
+        return;
+
+    package_lock lock(this);
+    while (async->busy || !async->jobs.empty())
+        cond_wait(async->idle, async->lock);
+    if (async->error)
+        rethrow_exception(async->error);
+#endif
+}
+
+#ifdef USE_ASYNC_SAVE
+void package::queue_job(writer_job job)
+{
+    package_lock lock(this);
+    job.seq = ++async->last_seq;
+    if (!job.commit)
+    {
+        pending_chunk &pc = pending[job.name];
+        pc.job = job.seq;
+        pc.data = job.data;
+    }
+    async->jobs.push_back(job);
+    cond_wake(async->wake);
+}
+
+void *package::writer_main(void *arg)
+{
+    static_cast<package*>(arg)->run_writer();
+    return nullptr;
+}
+
+void package::run_writer()
+{
+    mutex_lock(async->lock);
+    while (true)
+    {
+        while (async->jobs.empty() && !async->stop)
+            cond_wait(async->wake, async->lock);
+        // Everything queued is done even when stopping, unless discarded.
+        if (async->jobs.empty())
+            break;
+
+        const writer_job job = async->jobs.front();
+        async->jobs.pop_front();
+        async->busy = true;
+        // After an error, just wait for the game to notice it.
+        if (!async->error)
+        {
+            try
+            {
+                do_job(job);
+                auto pc = pending.find(job.name);
+                if (!job.commit && pc != pending.end()
+                    && pc->second.job == job.seq)
+                {
+                    pending.erase(pc);
+                }
+            }
+            catch (...)
+            {
+                async->error = current_exception();
+            }
+        }
+        async->busy = false;
+        cond_wake(async->idle);
+    }
+    mutex_unlock(async->lock);
+}
+
+void package::do_job(const writer_job &job)
+{
+    if (job.commit)
+    {
+        commit_now();
+        return;
+    }
+    if (!job.data)
+    {
+        remove_chunk(job.name);
+        return;
+    }
+
+    const vector<char> *data = job.data.get();
+#ifdef USE_ZLIB
+    // Compress without holding the game up, if it wants to read something.
+    vector<char> compressed;
+    if (codec == PCODEC_ZLIB)
+    {
+        const int zlevel = level;
+        uLongf len = compressBound(data->size());
+        compressed.resize(len);
+        mutex_unlock(async->lock);
+        const int res = compress2((Bytef*)&compressed[0], &len,
+                                  (const Bytef*)data->data(), data->size(),
+                                  zlevel);
+        mutex_lock(async->lock);
+        if (res != Z_OK)
+            fail("save file compression failed: %s", zError(res));
+        compressed.resize(len);
+        data = &compressed;
+    }
+#endif
+
+    chunk_writer out(this, job.name, false, false);
+    if (!data->empty())
+        out.write(data->data(), data->size());
+}
+
+void package::stop_writer(bool discard)
+{
+    mutex_lock(async->lock);
+    if (discard)
+    {
+        async->jobs.clear();
+        pending.clear();
+    }
+    async->stop = true;
+    cond_wake(async->wake);
+    mutex_unlock(async->lock);
+    thread_join(async->thread);
+
+    exception_ptr error = async->error;
+    mutex_destroy(async->lock);
+    cond_destroy(async->wake);
+    cond_destroy(async->idle);
+    delete async;
+    async = nullptr;
+
+    if (error && !discard)
+        rethrow_exception(error);
+}
+#endif
+
 // the amount of free space not at the end of file
 plen_t package::get_slack()
 {
+    flush();
     load_traces();
 
     plen_t slack = 0;
@@ -643,6 +1088,7 @@ plen_t package::get_slack()
 
 plen_t package::get_chunk_fragmentation(const string &name)
 {
+    flush();
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t frags = 0;
@@ -659,6 +1105,7 @@ plen_t package::get_chunk_fragmentation(const string &name)
 
 plen_t package::get_chunk_compressed_length(const string &name)
 {
+    flush();
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t len = 0;
@@ -677,23 +1124,47 @@ chunk_writer::chunk_writer(package *parent, const string &_name)
     : first_block(0), cur_block(0), block_len(0)
 {
     ASSERT(parent);
-    ASSERT(!parent->aborted);
+    pkg = parent;
+    buffered = pkg->async;
+    init(_name, true);
+}
+
+// Used by the package itself, which may need to write directly even with a
+// writer thread, or to write data it has compressed already.
+chunk_writer::chunk_writer(package *parent, const string &_name,
+                           bool buffer_it, bool compress)
+    : first_block(0), cur_block(0), block_len(0)
+{
+    ASSERT(parent);
+    pkg = parent;
+    buffered = buffer_it;
+    init(_name, compress);
+}
+
+void chunk_writer::init(const string &_name, bool compress)
+{
+    ASSERT(!pkg->aborted);
 
     // If you need more, please change {read,write}_directory().
     ASSERT(MAX_CHUNK_NAME_LENGTH < 256);
     ASSERT(_name.length() < MAX_CHUNK_NAME_LENGTH);
 
     dprintf("chunk_writer(%s): starting\n", _name.c_str());
-    pkg = parent;
-    pkg->n_users++;
+    {
+        package_lock lock(pkg);
+        pkg->n_users++;
+    }
     name = _name;
 
 #ifdef USE_ZLIB
+    deflating = compress && !buffered && pkg->codec == PCODEC_ZLIB;
+    if (!deflating)
+        return;
     zs.data_type = Z_BINARY;
     zs.zalloc    = 0;
     zs.zfree     = 0;
     zs.opaque    = Z_NULL;
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION))
+    if (deflateInit(&zs, pkg->level))
         fail("save file compression failed during init: %s", zs.msg);
 #define ZB_SIZE 32768
     zs.next_out  = z_buffer = (Bytef*)malloc(ZB_SIZE);
@@ -705,19 +1176,52 @@ chunk_writer::~chunk_writer()
 {
     dprintf("chunk_writer(%s): closing\n", name.c_str());
 
+#ifdef USE_ASYNC_SAVE
+    if (buffered)
+    {
+        {
+            package_lock lock(pkg);
+            ASSERT(pkg->n_users > 0);
+            pkg->n_users--;
+        }
+        if (pkg->aborted)
+            return;
+        package::writer_job job;
+        job.name = name;
+        job.data = make_shared<const vector<char>>(move(buffer));
+        job.commit = false;
+        pkg->queue_job(job);
+        return;
+    }
+#endif
+
     ASSERT(pkg->n_users > 0);
     pkg->n_users--;
     if (pkg->aborted)
     {
 #ifdef USE_ZLIB
-        // ignore errors, they're not relevant anymore
-        deflateEnd(&zs);
-        free(z_buffer);
+        if (deflating)
+        {
+            // ignore errors, they're not relevant anymore
+            deflateEnd(&zs);
+            free(z_buffer);
+        }
 #endif
         return;
     }
 
 #ifdef USE_ZLIB
+    if (deflating)
+        finish_deflate();
+#endif
+    if (cur_block)
+        finish_block(0);
+    pkg->finish_chunk(name, first_block);
+}
+
+#ifdef USE_ZLIB
+void chunk_writer::finish_deflate()
+{
     zs.avail_in = 0;
     int res;
     do
@@ -732,11 +1236,8 @@ chunk_writer::~chunk_writer()
     if (deflateEnd(&zs) != Z_OK)
         fail("save file compression failed during clean-up: %s", zs.msg);
     free(z_buffer);
-#endif
-    if (cur_block)
-        finish_block(0);
-    pkg->finish_chunk(name, first_block);
 }
+#endif
 
 void chunk_writer::raw_write(const void *data, plen_t len)
 {
@@ -782,7 +1283,19 @@ void chunk_writer::write(const void *data, plen_t len)
     ASSERT(data);
     ASSERT(!pkg->aborted);
 
+    if (buffered)
+    {
+        buffer.insert(buffer.end(), (const char*)data, (const char*)data + len);
+        return;
+    }
+
 #ifdef USE_ZLIB
+    if (!deflating)
+    {
+        raw_write(data, len);
+        return;
+    }
+
     zs.next_in  = (Bytef*)data;
     zs.avail_in = len;
     while (zs.avail_in)
@@ -806,11 +1319,19 @@ void chunk_reader::init(plen_t start)
 {
     ASSERT(!pkg->aborted);
     pkg->n_users++;
-    pkg->reader_count[start]++;
     first_block = next_block = start;
-    block_left = 0;
+    off = block_left = 0;
+#ifdef USE_ZLIB
+    eof = false;
+#endif
+    // Queued chunks are simply copied out of memory.
+    if (pending)
+        return;
+    pkg->reader_count[start]++;
 
 #ifdef USE_ZLIB
+    if (pkg->codec != PCODEC_ZLIB)
+        return;
     if (!start)
         corrupted("save file corrupted -- zlib header missing");
 
@@ -821,7 +1342,6 @@ void chunk_reader::init(plen_t start)
     zs.avail_in  = 0;
     if (inflateInit(&zs))
         fail("save file decompression failed during init: %s", zs.msg);
-    eof = false;
 #endif
 }
 
@@ -836,64 +1356,65 @@ chunk_reader::chunk_reader(package *parent, plen_t start)
 chunk_reader::chunk_reader(package *parent, const string &_name)
 {
     ASSERT(parent);
+    package_lock lock(parent);
     if (!parent->has_chunk(_name))
         corrupted("save file corrupted -- chunk \"%s\" missing", _name.c_str());
     dprintf("chunk_reader(%s): starting\n", _name.c_str());
     pkg = parent;
-    init(parent->directory[_name]);
+    if (const package::pending_chunk *pc = map_find(pkg->pending, _name))
+        pending = pc->data;
+    init(pending ? 0 : pkg->directory[_name]);
 }
 
 chunk_reader::~chunk_reader()
 {
     dprintf("chunk_reader: closing\n");
 
+    package_lock lock(pkg);
+    if (!pending)
+    {
 #ifdef USE_ZLIB
-    if (inflateEnd(&zs) != Z_OK)
-        fail("save file decompression failed during clean-up: %s", zs.msg);
+        if (pkg->codec == PCODEC_ZLIB && inflateEnd(&zs) != Z_OK)
+            fail("save file decompression failed during clean-up: %s", zs.msg);
 #endif
-    ASSERT(pkg->reader_count[first_block] > 0);
-    if (!--pkg->reader_count[first_block])
-        pkg->reader_count.erase(first_block);
+        ASSERT(pkg->reader_count[first_block] > 0);
+        if (!--pkg->reader_count[first_block])
+            pkg->reader_count.erase(first_block);
+    }
     ASSERT(pkg->n_users > 0);
     pkg->n_users--;
 }
 
+// Move on to the next block of the chunk. Returns false at its end.
+bool chunk_reader::start_block()
+{
+    if (!next_block)
+        return false;
+
+    block_header bl;
+    pkg->read_at(next_block, &bl, sizeof(block_header));
+
+    off = next_block + sizeof(block_header);
+    block_left = htole(bl.len);
+    next_block = htole(bl.next);
+    // This reeks of on-disk corruption (zeroed data).
+    if (!block_left)
+        corrupted("save file corrupted -- empty block");
+    return true;
+}
+
 plen_t chunk_reader::raw_read(void *data, plen_t len)
 {
     void *buf = data;
     while (len)
     {
-        if (!block_left)
-        {
-            if (!next_block)
-                return (char*)buf - (char*)data;
-
-            block_header bl;
-            pkg->seek(next_block);
-            ssize_t res = ::read(pkg->fd, &bl, sizeof(block_header));
-            if (res < 0)
-                sysfail("error reading the save file");
-            if (res != sizeof(block_header))
-                corrupted("save file corrupted -- block past eof");
-
-            off = next_block + sizeof(block_header);
-            block_left = htole(bl.len);
-            next_block = htole(bl.next);
-            // This reeks of on-disk corruption (zeroed data).
-            if (!block_left)
-                corrupted("save file corrupted -- empty block");
-        }
-        else
-            pkg->seek(off);
+        if (!block_left && !start_block())
+            return (char*)buf - (char*)data;
 
         plen_t s = len;
         if (s > block_left)
             s = block_left;
-        ssize_t res = ::read(pkg->fd, buf, s);
-        if (res < 0)
-            sysfail("error reading the save file");
-        if ((plen_t)res != s)
-            corrupted("save file corrupted -- block past eof");
+        pkg->read_at(off, buf, s);
 
         buf = (char*)buf + s;
         off += s;
@@ -904,13 +1425,46 @@ plen_t chunk_reader::raw_read(void *data, plen_t len)
     return (char*)buf - (char*)data;
 }
 
+#ifdef USE_ZLIB
+// Hand out the rest of the current block straight from the package's
+// mapping, without copying it. Returns 0 if that isn't possible (or the
+// chunk is over), in which case raw_read() has to be used instead.
+plen_t chunk_reader::raw_span(const Bytef **data)
+{
+    if (!block_left && !start_block())
+        return 0;
+
+    const char *m = pkg->mapped(off, block_left);
+    if (!m)
+        return 0;
+
+    const plen_t s = block_left;
+    *data = (const Bytef*)m;
+    off += s;
+    block_left = 0;
+    return s;
+}
+#endif
+
 plen_t chunk_reader::read(void *data, plen_t len)
 {
     ASSERT(data);
     if (pkg->aborted)
         return 0;
 
+    if (pending)
+    {
+        const plen_t s = min<plen_t>(len, pending->size() - off);
+        if (s)
+            memcpy(data, pending->data() + off, s);
+        off += s;
+        return s;
+    }
+
+    package_lock lock(pkg);
 #ifdef USE_ZLIB
+    if (pkg->codec != PCODEC_ZLIB)
+        return raw_read(data, len);
     if (!len)
         return 0;
     if (eof)
@@ -922,8 +1476,18 @@ plen_t chunk_reader::read(void *data, plen_t len)
     {
         if (!zs.avail_in)
         {
-            zs.next_in  = z_buffer;
-            zs.avail_in = raw_read(z_buffer, sizeof(z_buffer));
+            const Bytef *span;
+            if (plen_t s = raw_span(&span))
+            {
+                // zlib never writes through next_in.
+                zs.next_in  = const_cast<Bytef*>(span);
+                zs.avail_in = s;
+            }
+            else
+            {
+                zs.next_in  = z_buffer;
+                zs.avail_in = raw_read(z_buffer, sizeof(z_buffer));
+            }
             if (!zs.avail_in)
                 corrupted("save file corrupted -- block truncated");
         }
@@ -944,14 +1508,19 @@ plen_t chunk_reader::read(void *data, plen_t len)
 
 void chunk_reader::read_all(vector<char> &data)
 {
-#define SPACE 1024
-    plen_t s, at;
-    do
+    // Grow the buffer geometrically, so that big chunks aren't inflated (and
+    // reallocated) a kilobyte at a time.
+    plen_t space = 1024;
+    while (true)
     {
-        at = data.size();
-        data.resize(at + SPACE);
-        s = read(&data[at], SPACE);
-    } while (s == SPACE);
-    data.resize(at + s);
-#undef SPACE
+        const plen_t at = data.size();
+        data.resize(at + space);
+        const plen_t s = read(&data[at], space);
+        if (s < space)
+        {
+            data.resize(at + s);
+            return;
+        }
+        space = data.size();
+    }
 }
@@ -2,7 +2,16 @@
 
 #define USE_ZLIB
 
+#ifdef UNIX
+#define USE_MMAP
+#endif
+
+#if defined(UNIX) && !defined(__ANDROID__)
+#define USE_ASYNC_SAVE
+#endif
+
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -13,6 +22,7 @@
 using std::map;
 using std::pair;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -24,6 +34,22 @@ using std::vector;
 
 typedef uint32_t plen_t;
 
+// How the chunks of a package are compressed. The codec is recorded in the
+// file header, where packages from before codecs existed have a zero, so
+// these values must never be renumbered.
+enum package_codec
+{
+    PCODEC_ZLIB,
+    PCODEC_NONE,
+    NUM_PCODECS
+};
+
+#ifdef USE_ZLIB
+#define PCODEC_DEFAULT PCODEC_ZLIB
+#else
+#define PCODEC_DEFAULT PCODEC_NONE
+#endif
+
 class package;
 
 class chunk_writer
@@ -34,12 +60,23 @@ private:
     plen_t first_block;
     plen_t cur_block;
     plen_t block_len;
+    // Chunks for the writer thread are only collected here; it compresses
+    // and writes them later.
+    bool buffered;
+    vector<char> buffer;
 #ifdef USE_ZLIB
+    bool deflating;
     z_stream zs;
     Bytef *z_buffer;
 #endif
+    chunk_writer(package *parent, const string &_name, bool buffer_it,
+                 bool compress);
+    void init(const string &_name, bool compress);
     void raw_write(const void *data, plen_t len);
     void finish_block(plen_t next);
+#ifdef USE_ZLIB
+    void finish_deflate();
+#endif
 public:
     chunk_writer(package *parent, const string &_name);
     ~chunk_writer();
@@ -55,11 +92,15 @@ private:
     package *pkg;
     plen_t first_block, next_block;
     plen_t off, block_left;
+    // A chunk the writer thread hasn't got to yet is read from memory.
+    shared_ptr<const vector<char>> pending;
 #ifdef USE_ZLIB
     bool eof;
     z_stream zs;
     Bytef z_buffer[32768];
+    plen_t raw_span(const Bytef **data);
 #endif
+    bool start_block();
     plen_t raw_read(void *data, plen_t len);
 public:
     chunk_reader(package *parent, const string &_name);
@@ -84,6 +125,19 @@ public:
     void abort();
     void unlink();
 
+    // Hand compression, block allocation and commits over to a thread of
+    // their own; writes and commit() then return as soon as their data is
+    // queued. flush() waits until everything queued so far has been done,
+    // and reports any error the thread ran into.
+    void write_in_background();
+    void flush();
+
+    // Only a package without chunks may switch codecs; the zlib level can
+    // be changed at any time, and affects only chunks written afterwards.
+    void set_codec(package_codec new_codec);
+    package_codec get_codec() const { return codec; }
+    void set_compression_level(int level);
+
     // statistics
     plen_t get_slack();
     plen_t get_size() const { return file_len; };
@@ -97,8 +151,27 @@ private:
     int n_users;
     bool dirty;
     bool aborted;
+    package_codec codec;
+    int level;
+    struct writer_thread;
+    writer_thread *async;
+    // Chunks queued for the writer thread, and the job that will write (or,
+    // without data, delete) them.
+    struct pending_chunk
+    {
+        unsigned int job;
+        shared_ptr<const vector<char>> data;
+    };
+    map<string, pending_chunk> pending;
 #ifdef DO_FSYNC
     bool tmp;
+#endif
+#ifdef USE_MMAP
+    // Read-only view of the file, as of the last load() or commit().
+    const char *mapping;
+    plen_t mapping_len;
+    void map_file();
+    void unmap_file();
 #endif
     map<string, plen_t> directory;
     map<plen_t, plen_t> free_blocks;
@@ -110,11 +183,25 @@ private:
     plen_t alloc_block(plen_t &size);
     void finish_chunk(const string &name, plen_t at);
     void free_chunk(const string &name);
+    void remove_chunk(const string &name);
+    void commit_now();
+    void sync_data();
+#ifdef USE_ASYNC_SAVE
+    struct writer_job;
+    void queue_job(writer_job job);
+    void do_job(const writer_job &job);
+    void run_writer();
+    static void *writer_main(void *arg);
+    void stop_writer(bool discard);
+    friend class package_lock;
+#endif
     plen_t write_directory();
     void collect_blocks();
     void free_block_chain(plen_t at);
     void free_block(plen_t at, plen_t size);
     void seek(plen_t to);
+    const char *mapped(plen_t at, plen_t len) const;
+    void read_at(plen_t at, void *data, plen_t len);
     void fsck();
     void read_directory(plen_t start, uint8_t version);
     void trace_chunk(plen_t start);
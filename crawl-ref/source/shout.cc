@@ -18,6 +18,7 @@
 #include "english.h"
 #include "env.h"
 #include "exercise.h"
+#include "feature.h"
 #include "ghost.h"
 #include "hints.h"
 #include "item-status-flag-type.h"
@@ -33,10 +34,15 @@
 #include "state.h"
 #include "stringutil.h"
 #include "terrain.h"
+#include "unwind.h"
 #include "view.h"
 #include "viewchar.h"
 
-static noise_grid _noise_grid;
+// Noises are registered on one grid while the other is propagated (and
+// then cleared for next time), so that monsters who yip on hearing a noise
+// don't disturb the propagation.
+static noise_grid _noise_grids[2];
+static noise_grid *_noise_grid = &_noise_grids[0];
 static void _actor_apply_noise(actor *act,
                                const coord_def &apparent_source,
                                int noise_intensity_millis);
@@ -763,17 +769,26 @@ void yell(const actor* mon)
 
 void apply_noises()
 {
-    // [ds] This copying isn't awesome, but we cannot otherwise handle
-    // the case where one set of noises wakes up monsters who then let
-    // out yips of their own, modifying _noise_grid while it is in the
-    // middle of propagate_noise().
-    if (_noise_grid.dirty())
+    static bool propagating = false;
+
+    if (!_noise_grid->dirty())
+        return;
+
+    // Should something in the noise effects apply noises in turn, the
+    // spare grid is busy; fall back to copying.
+    if (propagating)
     {
-        noise_grid copy = _noise_grid;
-        // Reset the main grid.
-        _noise_grid.reset();
+        noise_grid copy = *_noise_grid;
+        _noise_grid->reset();
         copy.propagate_noise();
+        return;
     }
+
+    unwind_bool busy(propagating, true);
+    noise_grid &grid = *_noise_grid;
+    _noise_grid = &_noise_grids[_noise_grid == &_noise_grids[0]];
+    grid.propagate_noise();
+    grid.reset();
 }
 
 // noisy() has a messaging service for giving messages to the player
@@ -814,7 +829,7 @@ bool noisy(int original_loudness, const coord_def& where,
     // Add +1 to scaled_loudness so that all squares adjacent to a
     // sound of loudness 1 will hear the sound.
     const string noise_msg(msg? msg : "");
-    _noise_grid.register_noise(
+    _noise_grid->register_noise(
         noise_t(where, noise_msg, (scaled_loudness + 1) * multiplier, who));
 
     // Some users of noisy() want an immediate answer to whether the
@@ -851,10 +866,8 @@ bool fake_noisy(int loudness, const coord_def& where)
 
 // Currently noise attenuation depends solely on the feature in question.
 // Permarock walls are assumed to completely kill noise.
-static int _noise_attenuation_millis(const coord_def &pos)
+static int _feat_noise_attenuation_millis(dungeon_feature_type feat)
 {
-    const dungeon_feature_type feat = env.grid(pos);
-
     if (feat_is_permarock(feat))
         return NOISE_ATTENUATION_COMPLETE;
 
@@ -866,6 +879,28 @@ static int _noise_attenuation_millis(const coord_def &pos)
                                           1);
 }
 
+// Looked up for every cell a noise passes through, so worked out once per
+// feature rather than through the feat_is_* calls each time.
+static int _noise_attenuation_millis(const coord_def &pos)
+{
+    static int attenuation[NUM_FEATURES];
+    static bool initialised = false;
+
+    if (!initialised)
+    {
+        for (int i = 0; i < NUM_FEATURES; ++i)
+        {
+            const auto feat = static_cast<dungeon_feature_type>(i);
+            // Some feature numbers are unused (or only kept for old saves).
+            if (is_valid_feature_type(feat))
+                attenuation[i] = _feat_noise_attenuation_millis(feat);
+        }
+        initialised = true;
+    }
+
+    return attenuation[env.grid(pos)];
+}
+
 noise_cell::noise_cell()
     : neighbour_delta(0, 0), noise_id(-1), noise_intensity_millis(0),
       noise_travel_distance(0)
@@ -919,6 +954,8 @@ void noise_grid::reset()
 {
     cells.init(noise_cell());
     noises.clear();
+    noise_perimeter[0].clear();
+    noise_perimeter[1].clear();
     affected_actor_count = 0;
 }
 
@@ -946,7 +983,6 @@ void noise_grid::propagate_noise()
     dprf(DIAG_NOISE, "noise_grid: %u noises to apply",
          (unsigned int)noises.size());
 #endif
-    vector<coord_def> noise_perimeter[2];
     int circ_index = 0;
 
     for (const noise_t &noise : noises)
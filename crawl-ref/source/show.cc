@@ -429,8 +429,7 @@ static void _update_monster(monster* mons)
     if (mons->visible_to(&you))
     {
         mons->ensure_has_client_id();
-        monster_info mi(mons);
-        env.map_knowledge(gp).set_monster(mi);
+        env.map_knowledge(gp).set_monster(mons);
         return;
     }
 
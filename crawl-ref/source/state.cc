@@ -48,7 +48,8 @@ game_state::game_state()
       throttle(false),
       bypassed_startup_menu(false),
 #endif
-      show_more_prompt(true), terminal_resize_handler(nullptr),
+      show_more_prompt(true), headless_turns(0),
+      terminal_resize_handler(nullptr),
       terminal_resize_check(nullptr), doing_prev_cmd_again(false),
       prev_cmd(CMD_NO_CMD), repeat_cmd(CMD_NO_CMD),
       cmd_repeat_started_unsafe(false), lua_calls_no_turn(0),
@@ -92,6 +92,8 @@ struct game_state
 
     bool show_more_prompt;  // Set to false to disable --more-- prompts.
 
+    int headless_turns;     // -headless exits after this many turns; 0: never.
+
     string sprint_map;      // Sprint map set on command line, if any.
 
     string map;             // Map selected in the newgame menu
@@ -257,6 +257,7 @@ enum tag_minor_version
     TAG_MINOR_GOLDIFY_MANUALS,     // Move manuals out of the inventory
     TAG_MINOR_UNCURSE,             // Remove curses from items
     TAG_MINOR_NEW_ASHENZARI,       // New Ashenzari
+    TAG_MINOR_LEVEL_DELTAS,        // Levels may be saved as deltas
 #endif
     NUM_TAG_MINORS,
     TAG_MINOR_VERSION = NUM_TAG_MINORS - 1
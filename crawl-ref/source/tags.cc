@@ -140,6 +140,13 @@ void reader::close()
 
 void reader::advance(size_t offset)
 {
+    // Files and buffers can skip straight there.
+    if (!_chunk)
+    {
+        read(nullptr, offset);
+        return;
+    }
+
     char junk[128];
 
     while (offset)
@@ -234,7 +241,7 @@ void reader::fail_if_not_eof(const string &name)
     char dummy;
     if (_chunk ? _chunk->read(&dummy, 1) :
         _file ? (fgetc(_file) != EOF) :
-        _read_offset >= _pbuf->size())
+        _read_offset < _pbuf->size())
     {
         fail("Incomplete read of \"%s\" - aborting.", name.c_str());
     }
@@ -6083,7 +6090,10 @@ static void _tag_read_level(reader &th)
             unmarshallMapCell(th, env.map_knowledge[i][j]);
             // Fixup positions
             if (env.map_knowledge[i][j].monsterinfo())
-                env.map_knowledge[i][j].monsterinfo()->pos = coord_def(i, j);
+            {
+                env.map_knowledge[i][j].mutable_monsterinfo()->pos
+                    = coord_def(i, j);
+            }
             if (env.map_knowledge[i][j].cloudinfo())
                 env.map_knowledge[i][j].cloudinfo()->pos = coord_def(i, j);
 
@@ -6909,6 +6919,8 @@ static void _tag_read_level_monsters(reader &th)
         if (!m.alive())
             continue;
 
+        note_monster_slot(m);
+
         monster *dup_m = monster_by_mid(m.mid);
 
 #if TAG_MAJOR_VERSION == 34
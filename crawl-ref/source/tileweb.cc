@@ -66,6 +66,10 @@
 
 //#define DEBUG_WEBSOCKETS
 
+// How many bytes a destination can fall behind before it is skipped ahead
+// and sent the whole state again.
+#define MAX_OUTPUT_LAG (2 * 1024 * 1024)
+
 static unsigned int get_milliseconds()
 {
     // This is Unix-only, but so is Webtiles at the moment.
@@ -78,6 +82,11 @@ static unsigned int get_milliseconds()
 TilesFramework tiles;
 
 TilesFramework::TilesFramework() :
+      m_out_first(0),
+      m_out_bytes(0),
+      m_resync_count(0),
+      m_resync_current(0),
+      m_need_resync(false),
       m_controlled_from_web(false),
       _send_lock(false),
       m_last_ui_state(UI_INIT),
@@ -89,6 +98,8 @@ TilesFramework::TilesFramework() :
       m_current_flash_colour(BLACK),
       m_next_flash_colour(BLACK),
       m_need_full_map(true),
+      m_packed_map(false),
+      m_packing(false),
       m_text_menu("menu_txt"),
       m_print_fg(15)
 {
@@ -107,6 +118,15 @@ void TilesFramework::shutdown()
     if (m_sock_name.empty())
         return;
 
+    // Give the last messages (like the exit reason) a few seconds to get
+    // through; nothing else is waiting on us now.
+    const unsigned int deadline = get_milliseconds() + 5000;
+    while (!m_out_queue.empty() && get_milliseconds() < deadline)
+    {
+        usleep(10 * 1000);
+        _flush_output();
+    }
+
     close(m_sock);
     remove(m_sock_name.c_str());
 }
@@ -143,12 +163,6 @@ bool TilesFramework::initialise()
     // Need small maximum message size to avoid crashes in OS X
     m_max_msg_size = 2048;
 
-    struct timeval tv;
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    if (setsockopt(m_sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0)
-        die("Can't set send timeout!");
-
     if (m_await_connection)
         _await_connection();
 
@@ -197,86 +211,152 @@ void TilesFramework::finish_message()
     }
 
     m_msg_buf.append("\n");
-    const char* fragment_start = m_msg_buf.data();
-    const char* data_end = m_msg_buf.data() + m_msg_buf.size();
-    int fragments = 0;
-    while (fragment_start < data_end)
+    if (!m_dests.empty())
     {
-        int fragment_size = data_end - fragment_start;
-        if (fragment_size > m_max_msg_size)
-            fragment_size = m_max_msg_size;
-        fragments++;
+        m_out_queue.push_back({move(m_msg_buf), m_out_bytes, m_resync_current});
+        m_out_bytes += m_out_queue.back().data.size();
+    }
+    m_msg_buf.clear();
+    _flush_output();
+    m_need_flush = true;
+#ifdef DEBUG_WEBSOCKETS
+    // should the game actually crash in this case?
+    if (m_controlled_from_web && m_dests.size() == 0)
+        fprintf(stderr, "No open websockets after finish_message!!\n");
 
-        for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+    fprintf(stderr, "websocket: Queued %d bytes, %d messages pending.\n",
+                              initial_buf_size, (int) m_out_queue.size());
+#endif
+}
+
+// Send each destination as much of the queue as its socket will take right
+// now, and forget the messages everyone has been sent.
+void TilesFramework::_flush_output()
+{
+    for (unsigned int i = 0; i < m_dests.size(); ++i)
+    {
+        if (!_send_output(m_dests[i]))
         {
-            int retries = 30;
-            ssize_t sent = 0;
-            while (sent < fragment_size)
+            // the other side is dead
+            m_dests.erase(m_dests.begin() + i);
+            i--;
+        }
+    }
+
+    uint64_t done = m_out_first + m_out_queue.size();
+    for (const Destination &dest : m_dests)
+        done = min(done, dest.next);
+    for (; m_out_first < done; ++m_out_first)
+        m_out_queue.pop_front();
+}
+
+// Returns false if the destination has gone away.
+bool TilesFramework::_send_output(Destination &dest)
+{
+    const uint64_t end = m_out_first + m_out_queue.size();
+    while (dest.next < end)
+    {
+        const OutMessage &msg = m_out_queue[dest.next - m_out_first];
+
+        if (dest.offset == 0)
+        {
+            if (dest.lagging)
             {
-                ssize_t retval = sendto(m_sock, fragment_start + sent,
-                    fragment_size - sent, 0, (sockaddr*) &m_dest_addrs[i],
-                    sizeof(sockaddr_un));
-#ifdef DEBUG_WEBSOCKETS
-                fprintf(stderr,
-                            "    trying to send fragment to client %d...", i);
-#endif
-                if (retval <= 0)
-                {
-                    const char *errmsg = retval == 0 ? "No bytes sent"
-                                                     : strerror(errno);
-                    if (--retries <= 0)
-                        die("Socket write error: %s", errmsg);
+                _skip_output(dest);
+                break;
+            }
 
-                    if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
-                        || errno == EINTR || errno == EAGAIN)
-                    {
-                        // Wait for half a second at first (up to five), then
-                        // try again.
-                        const int sleep_time = retries > 25 ? 2 * 1000
-                                             : retries > 10 ? 500 * 1000
-                                             : 5000 * 1000;
-#ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr, "failed (%s), sleeping for %dms.\n",
-                                                    errmsg, sleep_time / 1000);
-#endif
-                        usleep(sleep_time);
-                    }
-                    else if (errno == ECONNREFUSED || errno == ENOENT)
-                    {
-                        // the other side is dead
-#ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr,
-                            "failed (%s), breaking.\n", errmsg);
-#endif
-                        m_dest_addrs.erase(m_dest_addrs.begin() + i);
-                        i--;
-                        break;
-                    }
-                    else
-                        die("Socket write error: %s", errmsg);
-                }
-                else
-                {
+            // Resyncs are only for those who need them, and a destination
+            // waiting for one has no use for anything before it.
+            const bool wanted = dest.waiting ? msg.resync == dest.resync
+                                             : !msg.resync
+                                               || msg.resync == dest.resync;
+            if (!wanted)
+            {
+                dest.next++;
+                continue;
+            }
+            dest.waiting = false;
+        }
+
+        const size_t fragment_size = min(msg.data.size() - dest.offset,
+                                         (size_t) m_max_msg_size);
+        ssize_t retval = sendto(m_sock, msg.data.data() + dest.offset,
+                                fragment_size, MSG_DONTWAIT,
+                                (sockaddr*) &dest.addr, sizeof(sockaddr_un));
+        if (retval <= 0)
+        {
+            if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
+                || errno == EINTR || errno == EAGAIN)
+            {
+                // Try again with the next message, or from await_input().
+                break;
+            }
+            else if (errno == ECONNREFUSED || errno == ENOENT)
+            {
 #ifdef DEBUG_WEBSOCKETS
-                    fprintf(stderr, "fragment size %d sent.\n", fragment_size);
+                fprintf(stderr, "websocket: Send failed (%s), dropping.\n",
+                                strerror(errno));
 #endif
-                    sent += retval;
-                }
+                return false;
             }
+            else
+                die("Socket write error: %s", strerror(errno));
         }
 
-        fragment_start += fragment_size;
+        dest.offset += retval;
+        if (dest.offset == msg.data.size())
+        {
+            dest.offset = 0;
+            dest.next++;
+        }
     }
-    m_msg_buf.clear();
-    m_need_flush = true;
-#ifdef DEBUG_WEBSOCKETS
-    // should the game actually crash in this case?
-    if (m_controlled_from_web && m_dest_addrs.size() == 0)
-        fprintf(stderr, "No open websockets after finish_message!!\n");
 
-    fprintf(stderr, "websocket: Sent %d bytes in %d fragments.\n",
-                                                initial_buf_size, fragments);
+    if (dest.next < end && !dest.lagging)
+    {
+        const uint64_t sent = m_out_queue[dest.next - m_out_first].start
+                              + dest.offset;
+        if (m_out_bytes - sent > MAX_OUTPUT_LAG)
+        {
+            // Don't cut a message off halfway, though: the other side
+            // only knows where one ends by the newline.
+            dest.lagging = true;
+            if (dest.offset == 0)
+                _skip_output(dest);
+        }
+    }
+
+    return true;
+}
+
+// Give up on the rest of the queue for a destination that can't keep up,
+// and ask for a resync to bring it back up to date.
+void TilesFramework::_skip_output(Destination &dest)
+{
+#ifdef DEBUG_WEBSOCKETS
+    fprintf(stderr, "websocket: Destination fell %d bytes behind, skipping.\n",
+                    (int) (m_out_bytes - m_out_queue[dest.next
+                                                     - m_out_first].start));
 #endif
+    dest.next = m_out_first + m_out_queue.size();
+    dest.lagging = false;
+    dest.waiting = true;
+    dest.resync = m_resync_count + 1;
+    m_need_resync = true;
+}
+
+// Resend the whole state, to the destinations that skipped ahead only.
+void TilesFramework::_resync_lagging()
+{
+    if (!m_need_resync || _send_lock)
+        return;
+
+    flush_messages();
+    m_need_resync = false;
+    m_resync_current = ++m_resync_count;
+    _send_everything();
+    flush_messages();
+    m_resync_current = 0;
 }
 
 void TilesFramework::send_message(const char *format, ...)
@@ -319,7 +399,7 @@ void TilesFramework::_await_connection()
     if (m_sock_name.empty())
         return;
 
-    while (m_dest_addrs.size() == 0)
+    while (m_dests.size() == 0)
         _receive_control_message();
 }
 
@@ -373,9 +453,18 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         JsonWrapper primary = json_find_member(obj.node, "primary");
         primary.check(JSON_BOOL);
 
-        m_dest_addrs.push_back(addr);
+        Destination dest;
+        dest.addr = addr;
+        dest.next = m_out_first + m_out_queue.size();
+        dest.offset = 0;
+        dest.lagging = false;
+        dest.waiting = false;
+        dest.resync = 0;
+        m_dests.push_back(dest);
         m_controlled_from_web = primary->bool_;
     }
+    else if (msgtype == "packed_map")
+        m_packed_map = true;
     else if (msgtype == "key")
     {
         JsonWrapper keycode = json_find_member(obj.node, "keycode");
@@ -488,8 +577,16 @@ bool TilesFramework::await_input(wint_t& c, bool block)
 
             if (block)
             {
+                _resync_lagging();
                 tiles.flush_messages();
-                result = select(maxfd + 1, &fds, nullptr, nullptr, nullptr);
+
+                // Sends never wait for a slow reader, so keep retrying
+                // whatever is left while we wait for input.
+                timeval retry;
+                retry.tv_sec = 0;
+                retry.tv_usec = 20 * 1000;
+                result = select(maxfd + 1, &fds, nullptr, nullptr,
+                                m_out_queue.empty() ? nullptr : &retry);
             }
             else
             {
@@ -502,8 +599,15 @@ bool TilesFramework::await_input(wint_t& c, bool block)
         }
         while (result == -1 && errno == EINTR);
 
+        if (!m_out_queue.empty())
+            _flush_output();
+
         if (result == 0)
+        {
+            if (block)
+                continue;
             return false;
+        }
         else if (result > 0)
         {
             if (!m_sock_name.empty() && FD_ISSET(m_sock, &fds))
@@ -1332,6 +1436,153 @@ static inline unsigned _get_brand(int col)
                                             : unsigned{CHATTR_NORMAL};
 }
 
+/*
+  Packed map cells, sent as a base64 string in the "pcells" field of a map
+  message, are made of varints (7 bits per byte, low bits first):
+    header:  GXM, then the view origin x and y (zigzag)
+    cells:   how many grid squares (row by row) since the previous cell,
+             a bitmask of packed_cell_field, then each field present in
+             that order. Ints are zigzag, tile indices unsigned; glyphs are
+             a code point, flavour is floor and special, overlays are a
+             count and then the tiles. The flags field is a mask of which
+             packed_cell_flags changed followed by their new values.
+  Everything else about a cell (monsters, dolls) still goes in "cells".
+  The order of both enums is shared with map_knowledge.js.
+*/
+enum packed_cell_field
+{
+    PCF_FEAT,
+    PCF_MAP_FEATURE,
+    PCF_GLYPH,
+    PCF_COLOUR,
+    PCF_FG,
+    PCF_BASE,
+    PCF_BG,
+    PCF_CLOUD,
+    PCF_HALO,
+    PCF_ORB_GLOW,
+    PCF_BLOOD_ROTATION,
+    PCF_TRAVEL_TRAIL,
+    PCF_FLAVOUR,
+    PCF_OVERLAYS,
+    PCF_FLAGS,
+};
+
+enum packed_cell_flag
+{
+    PCFL_BLOODY,
+    PCFL_OLD_BLOOD,
+    PCFL_SILENCED,
+    PCFL_HIGHLIGHTED_SUMMONER,
+    PCFL_SANCTUARY,
+    PCFL_LIQUEFIED,
+    PCFL_QUAD_GLOW,
+    PCFL_DISJUNCT,
+    PCFL_MANGROVE_WATER,
+    PCFL_AWAKENED_FOREST,
+};
+
+static void _pack_varint(string &buf, uint64_t x)
+{
+    while (x >= 0x80)
+    {
+        buf.push_back((char) (x | 0x80));
+        x >>= 7;
+    }
+    buf.push_back((char) x);
+}
+
+static void _pack_int(string &buf, int x)
+{
+    _pack_varint(buf, ((uint32_t) x << 1) ^ (uint32_t) (x >> 31));
+}
+
+static string _base64(const string &data)
+{
+    static const char digits[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        const size_t n = min<size_t>(data.size() - i, 3);
+        uint32_t bits = (uint8_t) data[i] << 16;
+        if (n > 1)
+            bits |= (uint8_t) data[i + 1] << 8;
+        if (n > 2)
+            bits |= (uint8_t) data[i + 2];
+        out.push_back(digits[bits >> 18 & 63]);
+        out.push_back(digits[bits >> 12 & 63]);
+        out.push_back(n > 1 ? digits[bits >> 6 & 63] : '=');
+        out.push_back(n > 2 ? digits[bits & 63] : '=');
+    }
+    return out;
+}
+
+void TilesFramework::_write_cell_int(int field, const string& name, int value)
+{
+    if (m_packing)
+    {
+        m_packed_fields |= 1 << field;
+        _pack_int(m_packed_cell, value);
+    }
+    else
+        json_write_int(name, value);
+}
+
+void TilesFramework::_write_cell_tileidx(int field, const string& name,
+                                         tileidx_t t)
+{
+    if (m_packing)
+    {
+        m_packed_fields |= 1 << field;
+        _pack_varint(m_packed_cell, t);
+    }
+    else
+    {
+        json_write_name(name);
+        write_tileidx(t);
+    }
+}
+
+void TilesFramework::_write_cell_bool(int flag, const string& name, bool value)
+{
+    if (m_packing)
+    {
+        m_packed_fields |= 1 << PCF_FLAGS;
+        m_packed_flags_changed |= 1 << flag;
+        if (value)
+            m_packed_flags |= 1 << flag;
+    }
+    else
+        json_write_bool(name, value);
+}
+
+// Add the fields collected for a cell to the message's packed cells.
+void TilesFramework::_finish_packed_cell(const coord_def &gc, int &last_index)
+{
+    if (!m_packed_fields)
+        return;
+
+    if (m_packed_fields & 1 << PCF_FLAGS)
+    {
+        _pack_varint(m_packed_cell, m_packed_flags_changed);
+        _pack_varint(m_packed_cell, m_packed_flags);
+    }
+
+    const int index = gc.y * GXM + gc.x;
+    _pack_varint(m_packed_cells, index - last_index);
+    _pack_varint(m_packed_cells, m_packed_fields);
+    m_packed_cells.append(m_packed_cell);
+    last_index = index;
+
+    m_packed_cell.clear();
+    m_packed_fields = 0;
+    m_packed_flags_changed = 0;
+    m_packed_flags = 0;
+}
+
 void TilesFramework::write_tileidx(tileidx_t t)
 {
     // JS can only handle signed ints
@@ -1343,6 +1594,36 @@ void TilesFramework::write_tileidx(tileidx_t t)
         tiles.write_message("[%d,%d]", lo, hi);
 }
 
+/**
+ * Could the client's picture of a cell be out of date? Everything that
+ * _send_cell() compares must be compared here too.
+ */
+bool TilesFramework::_cell_changed(const coord_def &gc)
+{
+    const screen_cell_t &current_sc = m_current_view(gc);
+    const screen_cell_t &next_sc = m_next_view(gc);
+    const packed_cell &current_pc = current_sc.tile;
+    const packed_cell &next_pc = next_sc.tile;
+
+    if (current_sc.glyph != next_sc.glyph
+        || current_sc.colour != next_sc.colour
+        || current_pc != next_pc
+        || current_pc.is_highlighted_summoner
+           != next_pc.is_highlighted_summoner
+        || current_pc.flv.floor != next_pc.flv.floor
+        || current_pc.flv.special != next_pc.flv.special
+        || m_current_map_knowledge(gc) != env.map_knowledge(gc))
+    {
+        return true;
+    }
+
+    // The player's doll can change without anything else about the cell
+    // doing so, and unexplored cells join the explore horizon when one of
+    // their neighbours is seen.
+    return (next_pc.fg & TILE_FLAG_MASK) == TILEP_PLAYER
+           || is_explore_horizon(gc);
+}
+
 void TilesFramework::_send_cell(const coord_def &gc,
                                 const screen_cell_t &current_sc, const screen_cell_t &next_sc,
                                 const map_cell &current_mc, const map_cell &next_mc,
@@ -1350,7 +1631,7 @@ void TilesFramework::_send_cell(const coord_def &gc,
                                 bool force_full)
 {
     if (current_mc.feat() != next_mc.feat())
-        json_write_int("f", next_mc.feat());
+        _write_cell_int(PCF_FEAT, "f", next_mc.feat());
 
     if (next_mc.monsterinfo())
         _send_monster(gc, next_mc.monsterinfo(), new_monster_locs, force_full);
@@ -1359,11 +1640,16 @@ void TilesFramework::_send_cell(const coord_def &gc,
 
     map_feature mf = get_cell_map_feature(gc);
     if (get_cell_map_feature(current_mc) != mf)
-        json_write_int("mf", mf);
+        _write_cell_int(PCF_MAP_FEATURE, "mf", mf);
 
     // Glyph and colour
     char32_t glyph = next_sc.glyph;
-    if (current_sc.glyph != glyph)
+    if (current_sc.glyph != glyph && m_packing)
+    {
+        m_packed_fields |= 1 << PCF_GLYPH;
+        _pack_varint(m_packed_cell, glyph);
+    }
+    else if (current_sc.glyph != glyph)
     {
         char buf[5];
         buf[wctoutf8(buf, glyph)] = 0;
@@ -1374,7 +1660,7 @@ void TilesFramework::_send_cell(const coord_def &gc,
     {
         int col = next_sc.colour;
         col = (_get_brand(col) << 4) | macro_colour(col & 0xF);
-        json_write_int("col", col);
+        _write_cell_int(PCF_COLOUR, "col", col);
     }
 
     json_open_object("t");
@@ -1392,69 +1678,77 @@ void TilesFramework::_send_cell(const coord_def &gc,
         {
             fg_changed = true;
 
-            json_write_name("fg");
-            write_tileidx(next_pc.fg);
+            _write_cell_tileidx(PCF_FG, "fg", next_pc.fg);
             if (get_tile_texture(fg_idx) == TEX_DEFAULT)
-                json_write_int("base", (int) tileidx_known_base_item(fg_idx));
+            {
+                _write_cell_int(PCF_BASE, "base",
+                                (int) tileidx_known_base_item(fg_idx));
+            }
         }
 
         if (next_pc.bg != current_pc.bg)
-        {
-            json_write_name("bg");
-            write_tileidx(next_pc.bg);
-        }
+            _write_cell_tileidx(PCF_BG, "bg", next_pc.bg);
 
         if (next_pc.cloud != current_pc.cloud)
-        {
-            json_write_name("cloud");
-            write_tileidx(next_pc.cloud);
-        }
+            _write_cell_tileidx(PCF_CLOUD, "cloud", next_pc.cloud);
 
         if (next_pc.is_bloody != current_pc.is_bloody)
-            json_write_bool("bloody", next_pc.is_bloody);
+            _write_cell_bool(PCFL_BLOODY, "bloody", next_pc.is_bloody);
 
         if (next_pc.old_blood != current_pc.old_blood)
-            json_write_bool("old_blood", next_pc.old_blood);
+            _write_cell_bool(PCFL_OLD_BLOOD, "old_blood", next_pc.old_blood);
 
         if (next_pc.is_silenced != current_pc.is_silenced)
-            json_write_bool("silenced", next_pc.is_silenced);
+            _write_cell_bool(PCFL_SILENCED, "silenced", next_pc.is_silenced);
 
         if (next_pc.halo != current_pc.halo)
-            json_write_int("halo", next_pc.halo);
+            _write_cell_int(PCF_HALO, "halo", next_pc.halo);
 
         if (next_pc.is_highlighted_summoner
             != current_pc.is_highlighted_summoner)
         {
-            json_write_bool("highlighted_summoner",
-                            next_pc.is_highlighted_summoner);
+            _write_cell_bool(PCFL_HIGHLIGHTED_SUMMONER, "highlighted_summoner",
+                             next_pc.is_highlighted_summoner);
         }
 
         if (next_pc.is_sanctuary != current_pc.is_sanctuary)
-            json_write_bool("sanctuary", next_pc.is_sanctuary);
+            _write_cell_bool(PCFL_SANCTUARY, "sanctuary", next_pc.is_sanctuary);
 
         if (next_pc.is_liquefied != current_pc.is_liquefied)
-            json_write_bool("liquefied", next_pc.is_liquefied);
+            _write_cell_bool(PCFL_LIQUEFIED, "liquefied", next_pc.is_liquefied);
 
         if (next_pc.orb_glow != current_pc.orb_glow)
-            json_write_int("orb_glow", next_pc.orb_glow);
+            _write_cell_int(PCF_ORB_GLOW, "orb_glow", next_pc.orb_glow);
 
         if (next_pc.quad_glow != current_pc.quad_glow)
-            json_write_bool("quad_glow", next_pc.quad_glow);
+            _write_cell_bool(PCFL_QUAD_GLOW, "quad_glow", next_pc.quad_glow);
 
         if (next_pc.disjunct != current_pc.disjunct)
-            json_write_bool("disjunct", next_pc.disjunct);
+            _write_cell_bool(PCFL_DISJUNCT, "disjunct", next_pc.disjunct);
 
         if (next_pc.mangrove_water != current_pc.mangrove_water)
-            json_write_bool("mangrove_water", next_pc.mangrove_water);
+        {
+            _write_cell_bool(PCFL_MANGROVE_WATER, "mangrove_water",
+                             next_pc.mangrove_water);
+        }
 
         if (next_pc.awakened_forest != current_pc.awakened_forest)
-            json_write_bool("awakened_forest", next_pc.awakened_forest);
+        {
+            _write_cell_bool(PCFL_AWAKENED_FOREST, "awakened_forest",
+                             next_pc.awakened_forest);
+        }
 
         if (next_pc.blood_rotation != current_pc.blood_rotation)
-            json_write_int("blood_rotation", next_pc.blood_rotation);
+        {
+            _write_cell_int(PCF_BLOOD_ROTATION, "blood_rotation",
+                            next_pc.blood_rotation);
+        }
 
         if (next_pc.travel_trail != current_pc.travel_trail)
-            json_write_int("travel_trail", next_pc.travel_trail);
+        {
+            _write_cell_int(PCF_TRAVEL_TRAIL, "travel_trail",
+                            next_pc.travel_trail);
+        }
 
         if (_needs_flavour(next_pc) &&
             (next_pc.flv.floor != current_pc.flv.floor
@@ -1462,11 +1756,20 @@ void TilesFramework::_send_cell(const coord_def &gc,
              || !_needs_flavour(current_pc)
              || force_full))
         {
-            json_open_object("flv");
-            json_write_int("f", next_pc.flv.floor);
-            if (next_pc.flv.special)
-                json_write_int("s", next_pc.flv.special);
-            json_close_object();
+            if (m_packing)
+            {
+                m_packed_fields |= 1 << PCF_FLAVOUR;
+                _pack_int(m_packed_cell, next_pc.flv.floor);
+                _pack_int(m_packed_cell, next_pc.flv.special);
+            }
+            else
+            {
+                json_open_object("flv");
+                json_write_int("f", next_pc.flv.floor);
+                if (next_pc.flv.special)
+                    json_write_int("s", next_pc.flv.special);
+                json_close_object();
+            }
         }
 
         if (fg_idx >= TILEP_MCACHE_START)
@@ -1561,7 +1864,14 @@ void TilesFramework::_send_cell(const coord_def &gc,
             }
         }
 
-        if (overlays_changed)
+        if (overlays_changed && m_packing)
+        {
+            m_packed_fields |= 1 << PCF_OVERLAYS;
+            _pack_varint(m_packed_cell, next_pc.num_dngn_overlay);
+            for (int i = 0; i < next_pc.num_dngn_overlay; ++i)
+                _pack_int(m_packed_cell, next_pc.dngn_overlay[i]);
+        }
+        else if (overlays_changed)
         {
             json_open_array("ov");
             for (int i = 0; i < next_pc.num_dngn_overlay; ++i)
@@ -1608,6 +1918,19 @@ void TilesFramework::_mcache_ref(bool inc)
         }
 }
 
+#ifdef DEBUG_VIEW_STATS
+static unsigned long long _map_updates = 0;
+static unsigned long long _cells_sent = 0;
+
+static void _report_view_stats()
+{
+    if (!_map_updates)
+        return;
+    fprintf(stderr, "Map cells sent per update over %llu updates: %.1f\n",
+            _map_updates, (double) _cells_sent / _map_updates);
+}
+#endif
+
 void TilesFramework::_send_map(bool force_full)
 {
     // TODO: prevent in some other / better way?
@@ -1616,6 +1939,12 @@ void TilesFramework::_send_map(bool force_full)
 
     unwind_bool no_rentry(_send_lock, true);
 
+#ifdef DEBUG_VIEW_STATS
+    if (!_map_updates)
+        atexit(_report_view_stats);
+    ++_map_updates;
+#endif
+
     map<uint32_t, coord_def> new_monster_locs;
 
     force_full = force_full || m_need_full_map;
@@ -1654,6 +1983,14 @@ void TilesFramework::_send_map(bool force_full)
     coord_def last_gc(0, 0);
     bool send_gc = true;
 
+    m_packing = m_packed_map;
+    m_packed_cells.clear();
+    m_packed_cell.clear();
+    m_packed_fields = 0;
+    m_packed_flags_changed = 0;
+    m_packed_flags = 0;
+    int last_index = -1;
+
     json_open_array("cells");
     for (int y = 0; y < GYM; y++)
         for (int x = 0; x < GXM; x++)
@@ -1676,6 +2013,19 @@ void TilesFramework::_send_map(bool force_full)
             if (m_origin.equals(-1, -1))
                 m_origin = gc;
 
+            // Every cell in view is marked dirty whenever the view is
+            // redrawn, but usually only a handful have changed.
+            if (!force_full && !_cell_changed(gc))
+            {
+                const monster_info *mon = env.map_knowledge(gc).monsterinfo();
+                if (mon && mon->client_id)
+                    new_monster_locs[mon->client_id] = gc;
+                continue;
+            }
+#ifdef DEBUG_VIEW_STATS
+            ++_cells_sent;
+#endif
+
             json_open_object();
             if (send_gc
                 || last_gc.x + 1 != gc.x
@@ -1702,9 +2052,23 @@ void TilesFramework::_send_map(bool force_full)
                 last_gc = gc;
             }
             json_close_object(true);
+
+            if (m_packing)
+                _finish_packed_cell(gc, last_index);
         }
     json_close_array(true);
 
+    if (!m_packed_cells.empty())
+    {
+        string header;
+        _pack_varint(header, GXM);
+        _pack_int(header, m_origin.x);
+        _pack_int(header, m_origin.y);
+        json_write_string("pcells", _base64(header + m_packed_cells));
+        m_packed_cells.clear();
+    }
+    m_packing = false;
+
     json_close_object(true);
 
     finish_message();
@@ -1755,6 +2119,15 @@ void TilesFramework::_send_monster(const coord_def &gc, const monster_info* m,
 
     if (last == nullptr)
         force_full = true;
+    else if (last == m && !force_full)
+    {
+        // The cell still shares the snapshot we sent last time, so there is
+        // nothing new to say about the monster.
+        if (m->is_named())
+            json_write_int("clientid", m->client_id);
+        json_close_object(true);
+        return;
+    }
 
     if (force_full || (last->full_name() != m->full_name()))
         json_write_string("name", m->full_name());
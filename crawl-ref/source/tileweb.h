@@ -8,6 +8,7 @@
 #ifdef USE_TILE_WEB
 
 #include <bitset>
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -24,6 +25,7 @@
 #include "tileweb-text.h"
 #include "viewgeom.h"
 
+using std::deque;
 using std::vector;
 
 class Menu;
@@ -153,7 +155,7 @@ public:
     void send_message(PRINTF(1, ));
     void flush_messages();
 
-    bool has_receivers() { return !m_dest_addrs.empty(); }
+    bool has_receivers() { return !m_dests.empty(); }
     bool is_controlled_from_web() { return m_controlled_from_web; }
 
     /* Webtiles can receive input both via stdin, and on the
@@ -220,7 +222,33 @@ protected:
     int m_sock;
     int m_max_msg_size;
     string m_msg_buf;
-    vector<sockaddr_un> m_dest_addrs;
+
+    // Finished messages not yet sent to every destination. Sends never
+    // block: each destination keeps its own place in the queue, and one
+    // that falls too far behind skips ahead and is sent the whole game
+    // state again instead.
+    struct OutMessage
+    {
+        string data;
+        uint64_t start;  // bytes queued before this message
+        unsigned resync; // if nonzero, only for destinations catching up
+    };
+    struct Destination
+    {
+        sockaddr_un addr;
+        uint64_t next;   // the message being sent, as a queue index
+        size_t offset;   // how much of it has been sent
+        bool lagging;    // skip ahead at the next message boundary
+        bool waiting;    // ignore everything until its resync starts
+        unsigned resync; // the resync this destination gets
+    };
+    deque<OutMessage> m_out_queue;
+    uint64_t m_out_first;     // queue index of m_out_queue.front()
+    uint64_t m_out_bytes;     // bytes ever queued
+    unsigned m_resync_count;
+    unsigned m_resync_current;
+    bool m_need_resync;
+    vector<Destination> m_dests;
 
     bool m_controlled_from_web;
     bool m_need_flush;
@@ -228,6 +256,10 @@ protected:
     bool _send_lock; // not thread safe
 
     void _await_connection();
+    void _flush_output();
+    bool _send_output(Destination &dest);
+    void _skip_output(Destination &dest);
+    void _resync_lagging();
     wint_t _handle_control_message(sockaddr_un addr, string data);
     wint_t _receive_control_message();
 
@@ -287,6 +319,16 @@ protected:
     map<uint32_t, coord_def> m_monster_locs;
     bool m_need_full_map;
 
+    // Map cells in the packed format (see _send_map), which the client
+    // asks for; anything it doesn't cover still goes out as JSON.
+    bool m_packed_map;
+    bool m_packing;
+    string m_packed_cells;
+    string m_packed_cell;
+    uint32_t m_packed_fields;
+    uint32_t m_packed_flags_changed;
+    uint32_t m_packed_flags;
+
     coord_def m_cursor[CURSOR_MAX];
     coord_def m_last_clicked_grid;
     bool m_text_cursor;
@@ -317,11 +359,16 @@ protected:
 
     void _send_cursor(cursor_type type);
     void _send_map(bool force_full = false);
+    bool _cell_changed(const coord_def &gc);
     void _send_cell(const coord_def &gc,
                     const screen_cell_t &current_sc, const screen_cell_t &next_sc,
                     const map_cell &current_mc, const map_cell &next_mc,
                     map<uint32_t, coord_def>& new_monster_locs,
                     bool force_full);
+    void _write_cell_int(int field, const string& name, int value);
+    void _write_cell_tileidx(int field, const string& name, tileidx_t t);
+    void _write_cell_bool(int flag, const string& name, bool value);
+    void _finish_packed_cell(const coord_def &gc, int &last_index);
     void _send_monster(const coord_def &gc, const monster_info* m,
                        map<uint32_t, coord_def>& new_monster_locs,
                        bool force_full);
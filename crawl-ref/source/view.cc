@@ -1330,6 +1330,8 @@ crawl_view_buffer view_dungeon(animation *a, bool anim_updates, view_renderer *r
 
 static bool _viewwindow_should_render()
 {
+    if (crawl_state.disables[DIS_DISPLAY])
+        return false;
     if (you.asleep())
         return false;
     if (mouse_control::current_mode() != MOUSE_MODE_NORMAL)
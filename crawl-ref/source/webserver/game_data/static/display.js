@@ -1,6 +1,6 @@
-define(["jquery", "comm", "./map_knowledge", "./view_data", "./monster_list",
-        "./minimap", "./dungeon_renderer"],
-function ($, comm, map_knowledge, view_data, monster_list, minimap,
+define(["jquery", "comm", "client", "./map_knowledge", "./view_data",
+        "./monster_list", "./minimap", "./dungeon_renderer"],
+function ($, comm, client, map_knowledge, view_data, monster_list, minimap,
           dungeon_renderer) {
     "use strict";
 
@@ -87,6 +87,9 @@ function ($, comm, map_knowledge, view_data, monster_list, minimap,
         if (data.vgrdc)
             minimap.do_view_center_update(data.vgrdc.x, data.vgrdc.y);
 
+        if (data.pcells)
+            map_knowledge.merge(map_knowledge.unpack(data.pcells));
+
         if (data.cells)
             map_knowledge.merge(data.cells);
 
@@ -112,6 +115,14 @@ function ($, comm, map_knowledge, view_data, monster_list, minimap,
         "map": handle_map_message,
     });
 
+    $(document).off("game_init.display")
+        .on("game_init.display", function () {
+            // Map cells can come packed (see tileweb.cc); spectators get
+            // whatever the player's client asked for.
+            if (!client.is_watching())
+                comm.send_message("packed_map");
+        });
+
     return {
         invalidate: invalidate,
         display: display,
@@ -197,6 +197,110 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
 
     }
 
+    // Field and flag order of packed map cells; see tileweb.cc.
+    var packed_fields = ["f", "mf", "g", "col", "fg", "base", "bg", "cloud",
+                         "halo", "orb_glow", "blood_rotation", "travel_trail",
+                         "flv", "ov", "flags"];
+    var packed_flags = ["bloody", "old_blood", "silenced",
+                        "highlighted_summoner", "sanctuary", "liquefied",
+                        "quad_glow", "disjunct", "mangrove_water",
+                        "awakened_forest"];
+    var cell_fields = { f: true, mf: true, g: true, col: true };
+
+    function unpack_cells(str)
+    {
+        var bytes = atob(str);
+        var pos = 0;
+
+        function varint()
+        {
+            var val = 0, mul = 1, b;
+            do
+            {
+                b = bytes.charCodeAt(pos++);
+                val += (b & 0x7f) * mul;
+                mul *= 128;
+            } while (b & 0x80);
+            return val;
+        }
+
+        function sint()
+        {
+            var val = varint();
+            return val % 2 ? -(val + 1) / 2 : val / 2;
+        }
+
+        // Same as the server's write_tileidx: [lo, hi] if it needs more
+        // than 32 bits.
+        function tileidx()
+        {
+            var lo = 0, hi = 0, shift = 0, b;
+            do
+            {
+                b = bytes.charCodeAt(pos++);
+                var v = b & 0x7f;
+                if (shift < 32)
+                    lo |= v << shift;
+                if (shift >= 32)
+                    hi |= v << (shift - 32);
+                else if (shift > 25)
+                    hi |= v >>> (32 - shift);
+                shift += 7;
+            } while (b & 0x80);
+            return hi ? [lo, hi] : lo;
+        }
+
+        var width = varint(), ox = sint(), oy = sint();
+        var index = -1;
+        var cells = [];
+        while (pos < bytes.length)
+        {
+            index += varint();
+            var mask = varint();
+            var cell = { x: index % width - ox,
+                         y: Math.floor(index / width) - oy };
+            var t = {};
+            for (var i = 0; i < packed_fields.length; ++i)
+            {
+                if (!(mask & (1 << i)))
+                    continue;
+
+                var name = packed_fields[i];
+                var target = cell_fields[name] ? cell : t;
+                if (name == "g")
+                    cell.g = String.fromCodePoint(varint());
+                else if (name == "fg" || name == "bg" || name == "cloud")
+                    t[name] = tileidx();
+                else if (name == "flv")
+                {
+                    t.flv = { f: sint() };
+                    var s = sint();
+                    if (s)
+                        t.flv.s = s;
+                }
+                else if (name == "ov")
+                {
+                    t.ov = [];
+                    for (var n = varint(); n > 0; --n)
+                        t.ov.push(sint());
+                }
+                else if (name == "flags")
+                {
+                    var changed = varint(), values = varint();
+                    for (var j = 0; j < packed_flags.length; ++j)
+                        if (changed & (1 << j))
+                            t[packed_flags[j]] = !!(values & (1 << j));
+                }
+                else
+                    target[name] = sint();
+            }
+            if (!$.isEmptyObject(t))
+                cell.t = t;
+            cells.push(cell);
+        }
+        return cells;
+    }
+
     function merge_diff(vals)
     {
         $.each(vals, function (i, val)
@@ -210,6 +314,7 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
     return {
         get: get,
         merge: merge_diff,
+        unpack: unpack_cells,
         clear: clear,
         touch: touch,
         visible: visible,